@@ -0,0 +1,106 @@
+#include "stdafx.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include "hit_test_benchmark.hpp"
+#include "hit_test_geometry.hpp"
+#include <random>
+#include "sdl_helpers.hpp"
+#include <vector>
+
+namespace
+{
+    // stands in for a control, which is about this large and allocated on its own
+    struct ScatteredControl
+    {
+        SDL_Rect Location;
+        bool Hidden;
+        uint8_t State[192];
+
+        virtual ~ScatteredControl() = default;
+    };
+
+    const int WindowWidth = 1920;
+    const int WindowHeight = 1080;
+    const size_t QueryCount = 4096;
+
+    // finds the topmost control the way the window did before it kept the geometry in arrays
+    int FindTopmostScattered(const std::vector<ScatteredControl*>& controls, const SDL_Point& point)
+    {
+        for (auto i = static_cast<ptrdiff_t>(controls.size()) - 1; i > -1; --i)
+        {
+            if (!controls[i]->Hidden && libsdlgui::SDLPointInRect(point, controls[i]->Location))
+                return static_cast<int>(i);
+        }
+
+        return -1;
+    }
+
+    // calls find for every point, returns the average nanoseconds per point and the sum of the results
+    template <typename Find>
+    std::pair<double, int64_t> Measure(const std::vector<SDL_Point>& points, Find find)
+    {
+        int64_t checksum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (auto& point : points)
+            checksum += find(point);
+
+        auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+        return std::make_pair(elapsed.count() / static_cast<double>(points.size()), checksum);
+    }
+
+    void RunCount(size_t count, std::mt19937& random)
+    {
+        std::uniform_int_distribution<int> x(0, WindowWidth - 1);
+        std::uniform_int_distribution<int> y(0, WindowHeight - 1);
+        std::uniform_int_distribution<int> size(16, 200);
+        std::uniform_int_distribution<int> hidden(0, 9);
+
+        // allocate the controls in a different order than they're drawn so walking them jumps around the heap
+        std::vector<std::unique_ptr<ScatteredControl>> storage(count);
+        std::vector<size_t> allocationOrder(count);
+        for (size_t i = 0; i < count; ++i)
+            allocationOrder[i] = i;
+
+        std::shuffle(allocationOrder.begin(), allocationOrder.end(), random);
+        for (auto index : allocationOrder)
+            storage[index] = std::make_unique<ScatteredControl>();
+
+        std::vector<ScatteredControl*> controls(count);
+        libsdlgui::detail::HitTestGeometry geometry;
+        geometry.Resize(count);
+        for (size_t i = 0; i < count; ++i)
+        {
+            auto& control = *storage[i];
+            control.Location = libsdlgui::SDLRect(x(random), y(random), size(random), size(random));
+            control.Hidden = hidden(random) == 0;
+            controls[i] = &control;
+            geometry.Set(i, control.Location, control.Hidden);
+        }
+
+        // random points mostly hit near the top, points outside the window test every control
+        std::vector<SDL_Point> hits(QueryCount);
+        for (auto& point : hits)
+            point = libsdlgui::SDLPoint(x(random), y(random));
+
+        std::vector<SDL_Point> misses(QueryCount, libsdlgui::SDLPoint(-1000, -1000));
+
+        for (auto pPoints : { &hits, &misses })
+        {
+            auto scattered = Measure(*pPoints, [&controls](const SDL_Point& point) { return FindTopmostScattered(controls, point); });
+            auto arrays = Measure(*pPoints, [&geometry](const SDL_Point& point) { return geometry.FindTopmost(point); });
+
+            std::printf("%7zu controls, %-6s  scattered %10.1f ns  arrays %10.1f ns  speedup %5.1fx%s\n",
+                count, pPoints == &hits ? "random" : "miss", scattered.first, arrays.first, scattered.first / arrays.first,
+                scattered.second == arrays.second ? "" : "  RESULTS DIFFER");
+        }
+    }
+}
+
+void RunHitTestBenchmark()
+{
+    // the same controls every run so the results can be compared
+    std::mt19937 random(1);
+    for (size_t count : { 1000u, 10000u, 100000u })
+        RunCount(count, random);
+}
@@ -0,0 +1,8 @@
+#ifndef HITTESTBENCHMARK_HPP
+#define HITTESTBENCHMARK_HPP
+
+// compares finding the topmost control under a point by walking controls scattered on the heap with
+// the window's structure of arrays hit test, for 1k to 100k controls.  run with "TestApp --hit-test-benchmark".
+void RunHitTestBenchmark();
+
+#endif // HITTESTBENCHMARK_HPP
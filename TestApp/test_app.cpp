@@ -1,5 +1,7 @@
 #include "stdafx.h"
+#include <cstring>
 #include "font_manager.hpp"
+#include "hit_test_benchmark.hpp"
 #include "sdl_helpers.hpp"
 #include "test_app.hpp"
 #include <SDL_keycode.h>
@@ -65,13 +67,15 @@ TestDialog::TestDialog(libsdlgui::Window* pWindow, const std::string& title, con
     });
 }
 
-TestWindow::TestWindow(const std::string& title, const libsdlgui::Dimentions& dimentions, SDL_WindowFlags windowFlags) :
-    m_frameNumber(0), Window(title, dimentions, windowFlags)
+TestWindow::TestWindow(const std::string& title, const libsdlgui::Dimentions& dimentions, SDL_WindowFlags windowFlags, const libsdlgui::RenderOptions& options) :
+    m_frameNumber(0), Window(title, dimentions, windowFlags, options)
 {
     m_label1 = std::make_unique<libsdlgui::Label>(this, libsdlgui::SDLRect(420, 128, 150, 32));
     m_label1->SetText("Nothing selected");
     m_label1->SetAlignment(libsdlgui::TextAlignment::MiddleCenter);
     m_dialog = std::make_unique<TestDialog>(this, "Test Dialog", libsdlgui::Dimentions(400, 300));
+    m_dialog->SetCacheAsLayer(true);
+    m_dialog->SetModal(true);
     m_button1 = std::make_unique<libsdlgui::Button>(this, libsdlgui::SDLRect(32, 32, 64, 32));
     m_button1->RegisterForClickCallback([this]()
     {
@@ -178,16 +182,32 @@ void TestWindow::NextFrame()
 
 int main(int argc, char* argv[])
 {
+    // measure the hit test instead of running the app
+    if (argc > 1 && std::strcmp(argv[1], "--hit-test-benchmark") == 0)
+    {
+        RunHitTestBenchmark();
+        return 0;
+    }
+
     libsdlgui::SDLInit sdlInit;
 
-    TestWindow win("Test App", libsdlgui::Dimentions(1024, 768), SDL_WINDOW_RESIZABLE);
+    libsdlgui::RenderOptions options;
+    options.VSync = true;
+    options.Pacing = libsdlgui::FramePacing::Adaptive;
+
+    TestWindow win("Test App", libsdlgui::Dimentions(1024, 768), SDL_WINDOW_RESIZABLE, options);
 
     bool quit = false;
     while (!quit)
     {
+        // sleep until there's input or a control's timer is due
         SDL_Event event;
-        if (SDL_PollEvent(&event))
-            quit = win.TranslateEvent(event);
+        if (SDL_WaitEventTimeout(&event, win.GetTimeUntilNextTimer()) != 0)
+            quit = libsdlgui::Window::DispatchEvent(event);
+
+        // drain all pending events so input isn't delayed by frame pacing
+        while (!quit && SDL_PollEvent(&event))
+            quit = libsdlgui::Window::DispatchEvent(event);
 
         win.Render();
     }
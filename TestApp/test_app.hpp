@@ -59,7 +59,7 @@ private:
     void NextFrame();
 
 public:
-    TestWindow(const std::string& title, const libsdlgui::Dimentions& dimentions, SDL_WindowFlags windowFlags);
+    TestWindow(const std::string& title, const libsdlgui::Dimentions& dimentions, SDL_WindowFlags windowFlags, const libsdlgui::RenderOptions& options);
 };
 
 #endif // TESTAPP_HPP
@@ -17,6 +17,7 @@ namespace libsdlgui
         SDLTexture m_texture;
         ButtonClickCallback m_onClick;
 
+        virtual bool IsOpaqueImpl() const;
         virtual void OnFocusAcquired();
         virtual void OnFocusLost();
         virtual void OnLeftClick(const SDL_Point&);
@@ -3,6 +3,9 @@
 
 #include <SDL_image.h>
 #include "flags.hpp"
+#include <memory>
+#include "sdl_helpers.hpp"
+#include <vector>
 
 namespace libsdlgui
 {
@@ -14,11 +17,51 @@ namespace libsdlgui
 
     namespace detail
     {
+        // forward declaration
+        class DisplayList;
+
         // returns true if the control can be dragged
         bool CanDrag(Control const* pControl);
 
-        // gets the Z-order of the control.  controls are rendered in ascending Z-order
-        uint8_t GetZOrder(Control const* pControl);
+        // returns true if the control's descendants are clipped to its bounds
+        bool ClipsChildren(Control const* pControl);
+
+        // returns true if the control is clipped by its ancestors.  controls
+        // that pop up outside of their parent (e.g. drop-down content) aren't.
+        bool ClipsToParent(Control const* pControl);
+
+        // clears the flag indicating the control's retained display list must be recorded again
+        void ClearDrawingDirty(Control* pControl);
+
+        // clears the flag indicating the control's layer must be redrawn
+        void ClearLayerDirty(Control* pControl);
+
+        // forgets that a mouse button was pressed on the control so releasing it isn't a click
+        void ClearMouseDown(Control* pControl);
+
+        // gets the drawing of the control recorded when it was last rendered, in window coordinates
+        DisplayList& GetDisplayList(Control* pControl);
+
+        // gets the texture the control and its descendants are cached in, nullptr if it isn't cached as a layer
+        SDLTexture* GetLayer(Control* pControl);
+
+        // gets the rectangle the control is clipped to when rendered.  it's empty if the control was culled.
+        SDL_Rect GetRenderClip(Control const* pControl);
+
+        // gets the control whose layer the control is rendered into, nullptr if it's rendered to the window
+        Control* GetRenderLayer(Control const* pControl);
+
+        // returns true if the control's retained display list must be recorded again before it's drawn
+        bool IsDrawingDirty(Control const* pControl);
+
+        // returns true if the control's layer was set rather than inherited from its parent
+        bool HasOwnZLayer(Control const* pControl);
+
+        // returns true if the control draws every pixel within its location when visible
+        bool IsOpaque(Control const* pControl);
+
+        // returns true if the control's layer must be redrawn before it's composited
+        bool IsLayerDirty(Control const* pControl);
 
         // notifies the control that its timer has elapsed
         void NotificationElapsedTime(Control* pControl);
@@ -53,6 +96,9 @@ namespace libsdlgui
         // sends mouse wheel event data to the control (e.g. scroll direction)
         void NotificationMouseWheel(Control* pControl, const SDL_MouseWheelEvent& wheelEvent);
 
+        // notifies the control that the content of the textures it renders into was lost
+        void NotificationRenderTargetsReset(Control* pControl);
+
         // sends text input events to the control (e.g. typing in a text box)
         void NotificationTextInput(Control* pControl, const SDL_TextInputEvent& textEvent);
 
@@ -62,35 +108,90 @@ namespace libsdlgui
         // render the control
         void Render(Control* pControl);
 
-        // sets the control's z-order. zero is the bottom and is the default value
-        void SetZOrder(Control* pControl, uint8_t zOrder);
+        // moves the control under the specified parent in the control tree
+        void SetParent(Control* pControl, Control* pParent);
+
+        // sets the rectangle the control is clipped to when rendered
+        void SetRenderClip(Control* pControl, const SDL_Rect& clip);
+
+        // sets the control whose layer the control is rendered into
+        void SetRenderLayer(Control* pControl, Control* pLayer);
     }
 
     // base class from which all controls must derive
     class Control
     {
+    public:
+        // the kinds of input a control handles.  the window doesn't call the handlers
+        // of a control for the kinds of input the control isn't interested in.
+        enum class EventInterest : uint8_t
+        {
+            None = 0,
+            Hover = 0x1,        // OnMouseEnter() and OnMouseExit()
+            MouseMotion = 0x2,  // OnMouseMotion()
+            MouseWheel = 0x4,   // OnMouseWheel()
+            Keyboard = 0x8,     // OnKeyboard()
+            TextInput = 0x10,   // OnTextInput()
+            All = 0x1f
+        };
+
+        // the bands controls are ordered in, the controls in a higher layer are drawn above and get
+        // the mouse before those in lower ones.  within a layer a control is above its ancestors and
+        // above the controls created before it.
+        enum class ZLayer : uint8_t
+        {
+            Content,
+            Popup,
+            Dialog,
+            Overlay
+        };
+
     private:
         enum State
         {
             None = 0,
             Hidden = 0x1,
             Focused = 0x2,
-            MouseDown = 0x4
+            MouseDown = 0x4,
+            CacheAsLayer = 0x8,
+            LayerDirty = 0x10,
+            Translating = 0x20,
+            DrawingDirty = 0x40,
+            OwnZLayer = 0x80
         };
 
+        // numbers the controls in the order they're created, which orders unrelated controls within a layer
+        static uint64_t s_nextSequence;
+
         Window* m_pWindow;
         Control* m_pParent;
+        std::vector<Control*> m_children;
+        SDL_Rect m_renderClip;
+        Control* m_pRenderLayer;
+        SDLTexture m_layer;
+        std::unique_ptr<detail::DisplayList> m_pDisplayList;
         detail::Flags<State> m_flags;
+        EventInterest m_interest;
         SDL_Rect m_loc;
         SDL_Color m_bColor;
         SDL_Color m_fColor;
         SDL_Color m_borderColor;
         uint8_t m_borderSize;
-        uint8_t m_zOrder;
+        ZLayer m_zLayer;
+        uint64_t m_sequence;
+
+        // marks the layers of the ancestors this control is drawn into as dirty
+        void InvalidateAncestors();
+
+        // sets the layer of the control and of its descendants that don't have a layer of their own
+        void PropagateZLayer(ZLayer layer);
 
         // extensibility points for derived classes (template method pattern)
 
         virtual bool CanDragImpl() const;
+        virtual bool ClipsChildrenImpl() const;
+        virtual bool ClipsToParentImpl() const;
+        virtual bool IsOpaqueImpl() const;
         virtual void OnElapsedTime();
         virtual void OnFocusAcquired();
         virtual void OnFocusLost();
@@ -105,16 +206,28 @@ namespace libsdlgui
         virtual void OnMouseExit();
         virtual void OnMouseMotion(const SDL_MouseMotionEvent&);
         virtual void OnMouseWheel(const SDL_MouseWheelEvent&);
+        virtual void OnRenderTargetsReset();
         virtual void OnResize(int, int);
         virtual void OnRightClick(const SDL_Point&);
         virtual void OnTextInput(const SDL_TextInputEvent&);
         virtual void OnWindowChanged();
-        virtual void OnZOrderChanged();
 
         virtual void RenderImpl() = 0;
 
         friend bool detail::CanDrag(Control const* pControl);
-        friend uint8_t detail::GetZOrder(Control const* pControl);
+        friend bool detail::ClipsChildren(Control const* pControl);
+        friend bool detail::ClipsToParent(Control const* pControl);
+        friend void detail::ClearDrawingDirty(Control* pControl);
+        friend void detail::ClearLayerDirty(Control* pControl);
+        friend void detail::ClearMouseDown(Control* pControl);
+        friend detail::DisplayList& detail::GetDisplayList(Control* pControl);
+        friend SDLTexture* detail::GetLayer(Control* pControl);
+        friend SDL_Rect detail::GetRenderClip(Control const* pControl);
+        friend Control* detail::GetRenderLayer(Control const* pControl);
+        friend bool detail::HasOwnZLayer(Control const* pControl);
+        friend bool detail::IsDrawingDirty(Control const* pControl);
+        friend bool detail::IsLayerDirty(Control const* pControl);
+        friend bool detail::IsOpaque(Control const* pControl);
         friend void detail::NotificationElapsedTime(Control* pControl);
         friend void detail::NotificationFocusAcquired(Control* pControl);
         friend void detail::NotificationFocusLost(Control* pControl);
@@ -125,10 +238,13 @@ namespace libsdlgui
         friend void detail::NotificationMouseExit(Control* pControl);
         friend void detail::NotificationMouseMotion(Control* pControl, const SDL_MouseMotionEvent& motionEvent);
         friend void detail::NotificationMouseWheel(Control* pControl, const SDL_MouseWheelEvent& wheelEvent);
+        friend void detail::NotificationRenderTargetsReset(Control* pControl);
         friend void detail::NotificationTextInput(Control* pControl, const SDL_TextInputEvent& textEvent);
         friend void detail::NotificationWindowChanged(Control* pControl);
         friend void detail::Render(Control* pControl);
-        friend void detail::SetZOrder(Control* pControl, uint8_t zOrder);
+        friend void detail::SetParent(Control* pControl, Control* pParent);
+        friend void detail::SetRenderClip(Control* pControl, const SDL_Rect& clip);
+        friend void detail::SetRenderLayer(Control* pControl, Control* pLayer);
 
     protected:
         // returns the window that owns the control
@@ -137,12 +253,31 @@ namespace libsdlgui
         // returns true if the control has focus
         bool HasFocus() const { return (m_flags & State::Focused) == State::Focused; }
 
+        // routes the mouse's events to the control wherever the mouse is until a button is released,
+        // e.g. while something is dragged.  no other control is hit tested or notified meanwhile.
+        void CapturePointer();
+
+        // returns true if the mouse's events are routed to the control
+        bool HasPointerCapture() const;
+
+        // stops routing the mouse's events to the control before a button is released
+        void ReleasePointerCapture();
+
         // returns true if the left mouse button was pressed on the control
         bool LeftMouseButtonDown(const SDL_MouseButtonEvent& buttonEvent);
 
         // returns true if the left mouse button was released on the control
         bool LeftMouseButtonUp(const SDL_MouseButtonEvent& buttonEvent);
 
+        // sets the kinds of input the control's handlers are called for, the default is all of them.
+        // a class that overrides a handler its base class isn't interested in must add that interest.
+        void SetEventInterest(EventInterest interest) { m_interest = interest; }
+
+        // caches the control and its descendants in a texture that's only redrawn when
+        // one of them is invalidated, moving the control doesn't redraw the texture.
+        // the layer is opaque, areas that aren't drawn are filled with the background color.
+        void SetCacheAsLayer(bool cache);
+
     public:
         Control(Window* pWindow, const SDL_Rect& location, Control* parent = nullptr);
         virtual ~Control();
@@ -153,15 +288,44 @@ namespace libsdlgui
         // gets the foreground color for the control
         SDL_Color GetForegroundColor() const { return m_fColor; }
 
+        // gets the kinds of input the control handles
+        EventInterest GetEventInterest() const { return m_interest; }
+
+        // returns true if the control handles any of the specified kinds of input
+        bool HasEventInterest(EventInterest interest) const
+        {
+            return (static_cast<uint8_t>(m_interest) & static_cast<uint8_t>(interest)) != 0;
+        }
+
         // returns true if the control is hidden and thus should not be rendered
         bool GetHidden() const { return (m_flags & State::Hidden) == State::Hidden; }
 
         // gets the location of the control
         SDL_Rect GetLocation() const { return m_loc; }
 
+        // gets the controls whose parent is this control
+        const std::vector<Control*>& GetChildren() const { return m_children; }
+
         // gets this control's parent, can be nullptr
         Control* GetParent() const { return m_pParent; }
 
+        // gets the number that orders the control after those created before it
+        uint64_t GetSequence() const { return m_sequence; }
+
+        // gets the layer the control is ordered in, it's its parent's unless it's been set
+        ZLayer GetZLayer() const { return m_zLayer; }
+
+        // returns true if the control and its descendants are cached in a layer
+        bool GetCacheAsLayer() const { return (m_flags & State::CacheAsLayer) == State::CacheAsLayer; }
+
+        // makes the control and its descendants without a layer of their own use its parent's layer again
+        void InheritZLayer();
+
+        // marks the control's appearance as changed so it's redrawn.  derived controls
+        // must call this when state that affects RenderImpl() changes, RenderImpl() is
+        // only called again after it and the recorded drawing is replayed until then.
+        void Invalidate();
+
         // sets the control's background color
         void SetBackgroundColor(const SDL_Color& color);
 
@@ -179,8 +343,20 @@ namespace libsdlgui
 
         // sets the control's location with respect to its owning window
         void SetLocation(const SDL_Rect& location);
+
+        // sets the layer the control is ordered in, its descendants are moved along unless they
+        // have a layer of their own.  the default is the parent's layer, InheritZLayer() restores
+        // it.  a control is never ordered below its ancestors, e.g. a pop-up within a dialog is
+        // above the dialog.
+        void SetZLayer(ZLayer layer);
     };
 
+    inline Control::EventInterest operator|(Control::EventInterest lhs, Control::EventInterest rhs)
+    {
+        return static_cast<Control::EventInterest>(static_cast<std::underlying_type<Control::EventInterest>::type>(lhs) |
+            static_cast<std::underlying_type<Control::EventInterest>::type>(rhs));
+    }
+
 } // namespace libsdlgui
 
 #endif // CONTROL_HPP
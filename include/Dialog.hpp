@@ -18,11 +18,14 @@ namespace libsdlgui
         SDLTexture m_titleTexture;
         Panel m_panel;
         bool m_canDrag;
+        bool m_modal;
 
         SDL_Rect GetCloseButtonLoc() const;
         SDL_Rect GetTitleBarLoc() const;
 
         virtual bool CanDragImpl() const;
+        virtual bool ClipsChildrenImpl() const;
+        virtual bool IsOpaqueImpl() const;
         virtual void OnHiddenChanged(bool isHidden);
         virtual void OnLeftClick(const SDL_Point& clickLoc);
         virtual void OnLocationChanged(int deltaX, int deltaY);
@@ -41,6 +44,17 @@ namespace libsdlgui
 
         // places the dialog in the center of its window
         void CenterDialog();
+
+        // returns true if the dialog is modal
+        bool GetModal() const { return m_modal; }
+
+        // sets whether the dialog is modal.  while a modal dialog is shown only it and its
+        // controls receive input, the window's other controls aren't hit tested or notified.
+        void SetModal(bool modal);
+
+        // caches the dialog and its controls in a texture that's only redrawn when one
+        // of them changes.  dragging a cached dialog is then a single copy per frame.
+        void SetCacheAsLayer(bool cache) { Control::SetCacheAsLayer(cache); }
     };
 
 } // namespace libsdlgui
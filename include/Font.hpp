@@ -2,6 +2,7 @@
 #define FONT_HPP
 
 #include "flags.hpp"
+#include <mutex>
 #include "sdl_helpers.hpp"
 
 namespace libsdlgui
@@ -23,6 +24,7 @@ namespace libsdlgui
         std::string m_name;
         uint8_t m_size;
         detail::Flags<Attributes> m_attribs;
+        mutable std::mutex m_lock;
 
     public:
         Font(TTFFont& ttfFont, const std::string& name, uint8_t size, Attributes attributes);
@@ -31,6 +33,11 @@ namespace libsdlgui
         uint32_t GetCharSize(char c);
         uint32_t GetHeight();
         uint32_t GetLineSkipHeight();
+
+        // gets the lock held while using the TTF_Font, which caches glyphs as text is measured
+        // and rendered.  text is rasterized on the task pool as well as on the UI thread.
+        std::mutex& GetLock() const { return m_lock; }
+
         std::string GetName() const { return m_name; }
         uint32_t GetTextSize(const char* text);
         TTF_Font* GetTtf() const { return m_ttf; }
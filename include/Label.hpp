@@ -16,6 +16,7 @@ namespace libsdlgui
         Font* m_pFont;
         TextAlignment m_alignment;
 
+        virtual bool IsOpaqueImpl() const;
         virtual void RenderImpl();
 
     public:
@@ -12,17 +12,20 @@ namespace libsdlgui
     private:
         std::vector<Control*> m_controls;
 
+        virtual bool ClipsChildrenImpl() const;
         virtual void OnHiddenChanged(bool isHidden);
         virtual void OnLocationChanged(int deltaX, int deltaY);
-        virtual void OnZOrderChanged();
         virtual void RenderImpl();
 
     public:
-        Panel(Window* pWindow, const SDL_Rect& location);
+        Panel(Window* pWindow, const SDL_Rect& location, Control* parent = nullptr);
 
-        // adds a control to the panel.  the location of
-        // the control must be within bounds of the panel
+        // adds a control to the panel.  the location of the control must be
+        // within bounds of the panel, the control is clipped to the panel.
         void AddControl(Control* pControl);
+
+        // caches the panel and its controls in a texture that's only redrawn when one of them changes
+        void SetCacheAsLayer(bool cache) { Control::SetCacheAsLayer(cache); }
     };
 
 } // namespace libsdlgui
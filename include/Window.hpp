@@ -1,18 +1,32 @@
 #ifndef WINDOW_HPP
 #define WINDOW_HPP
 
+#include <atomic>
+#include "command_queue.hpp"
+#include <coroutine>
+#include <exception>
 #include <filesystem>
 #include "dimentions.hpp"
 #include "flags.hpp"
 #include "font.hpp"
+#include "hit_test_geometry.hpp"
 #include <functional>
+#include <map>
+#include <memory>
+#include "latency_histogram.hpp"
+#include "render_options.hpp"
 #include "sdl_helpers.hpp"
 #include <SDL_events.h>
+#include <SDL_timer.h>
 #include <SDL_pixels.h>
 #include <SDL_render.h>
 #include <SDL_video.h>
 #include <string>
+#include "task_pool.hpp"
 #include "text_alignment.hpp"
+#include "texture_pool.hpp"
+#include <tuple>
+#include <unordered_map>
 #include <vector>
 
 namespace libsdlgui
@@ -25,9 +39,27 @@ namespace libsdlgui
 
     namespace detail
     {
+        // forward declarations
+        class DisplayList;
+        class GlyphAtlas;
+        class InputRecorder;
+        class RenderThread;
+
+        // gets a render target texture of at least the specified size from the window's texture pool
+        SDLTexture AcquireRenderTarget(Window* pWindow, int width, int height);
+
         // adds a control to the window so it can be rendered and receive events
         void AddControl(Window* pWindow, Control* pControl);
 
+        // notifies the window that the location or hidden state of the control has changed
+        void ControlGeometryChanged(Window* pWindow, Control* pControl);
+
+        // notifies the window that the layer or the parent of one of its controls has changed
+        void ControlOrderChanged(Window* pWindow, Control* pControl);
+
+        // creates a texture with the content of an ARGB8888 surface
+        SDLTexture CreateTextureForSurface(Window const* pWindow, SDL_Surface* pSurface);
+
         // create an SDLTexture object for the specified text
         SDLTexture CreateTextureForText(Window const* pWindow, const std::string& text, Font const* font, const SDL_Color& fgColor, const SDL_Color& bgColor);
 
@@ -37,9 +69,20 @@ namespace libsdlgui
         // gets the window's font
         Font* GetFont(Window const* pWindow);
 
+        // gets the glyphs for drawing numbers in the specified font and colors, they're rasterized on first use
+        GlyphAtlas* GetGlyphAtlas(Window* pWindow, Font const* font, const SDL_Color& fgColor, const SDL_Color& bgColor);
+
         // gets the window's foreground color
         SDL_Color GetForegroundColor(Window const* pWindow);
 
+        // gets the control the mouse's events are routed to, nullptr if none has captured the pointer
+        Control* GetPointerCapture(Window const* pWindow);
+
+        // makes the control modal, only it and its descendants receive input until it's removed.
+        // modal controls stack, the one pushed last is in effect.  pushing a control that's already
+        // modal leaves the stack as it is.
+        void PushModal(Window* pWindow, Control* pControl);
+
         // registers a control to receive a callback on the specified interval.
         // doing subsequent calls with the same control will change the interval.
         void RegisterForElapsedTimeNotification(Window* pWindow, Control* pControl, uint32_t ticks);
@@ -47,15 +90,78 @@ namespace libsdlgui
         // removes the specified control from the window
         void RemoveControl(Window* pWindow, Control* pControl);
 
+        // removes the control from the window's modal controls, the one beneath it takes effect
+        void RemoveModal(Window* pWindow, Control* pControl);
+
+        // returns true if the window's renderer can draw into textures
+        bool RenderTargetsSupported(Window const* pWindow);
+
+        // records an exception that left a coroutine, the next call to Render() on the thread throws it
+        void ReportTaskError(std::exception_ptr error);
+
+        // resumes the coroutine on the UI thread once the number of ticks has elapsed
+        void ResumeAfter(Window* pWindow, uint32_t ticks, std::coroutine_handle<> handle);
+
+        // resumes a coroutine that was recorded with SuspendTask()
+        void ResumeTask(Window* pWindow, std::coroutine_handle<> handle);
+
+        // routes the mouse's events to the control until a button is released, nullptr releases the capture
+        void SetPointerCapture(Window* pWindow, Control* pControl);
+
+        // records a coroutine that's waiting for the window so it's destroyed with the window if it's never resumed
+        void SuspendTask(Window* pWindow, std::coroutine_handle<> handle);
+
         // unregisters the elapsed time callback for the specified control
         void UnregisterForElapsedTimeNotification(Window* pWindow, Control* pControl);
+
+        // replaces the pixels of an area of a texture.  with a render thread the update is done by it after
+        // the frames published so far so they still draw the texture's previous content.
+        void UpdateTexture(Window const* pWindow, SDL_Texture* pTexture, const SDL_Rect& area, const void* pixels, int pitch);
+
+        // renders the specified text into an existing streaming texture, which is only
+        // reallocated (with room to grow) when the text doesn't fit within its capacity.
+        void UpdateTextureForText(Window const* pWindow, SDLTexture& texture, const std::string& text, Font const* font, const SDL_Color& fgColor, const SDL_Color& bgColor);
+
+        // class used for drawing into a texture.  the window's drawing routines take the same
+        // coordinates as before with origin, in window coordinates, being the texture's top-left
+        // corner.  when the object goes out of scope the previous target and clip are restored.
+        // the target changes are recorded in the frame's display list like the drawing.  drawing into
+        // the texture goes to the frame's list even while a control's retained list is recorded, as
+        // the texture keeps what's drawn and must not be drawn again when the retained list is replayed.
+        class RenderTargetHolder
+        {
+        private:
+            Window* m_pWindow;
+            DisplayList* m_pPrevRecording;
+            SDL_Texture* m_pPrevTarget;
+            SDL_Point m_prevOrigin;
+            SDL_Rect m_prevClip;
+            bool m_prevClipEnabled;
+
+        public:
+            RenderTargetHolder(Window* pWindow, const SDLTexture& target, const SDL_Point& origin);
+            RenderTargetHolder(const RenderTargetHolder&) = delete;
+            RenderTargetHolder& operator=(const RenderTargetHolder&) = delete;
+            ~RenderTargetHolder();
+        };
     }
 
     // class that represents the app's window
     class Window
     {
+    public:
+        using ImageLoadedCallback = std::function<void(SDLTexture&& texture)>;
+        using TickSource = std::function<uint32_t()>;
+
     private:
         using ControlElapsedTime = std::tuple<Control*, uint32_t, uint32_t>;
+        using DelayedResume = std::tuple<std::coroutine_handle<>, uint32_t, uint32_t>;
+        using GlyphAtlasKey = std::tuple<Font const*, uint32_t, uint32_t>;
+
+        // orders the runs of controls that start with a control without a parent or with a layer of its
+        // own: by its layer, which is at least that of its ancestors, then by the root it's in, with the
+        // runs nested in a root after the root, then by creation order.
+        using RunKey = std::tuple<uint8_t, uint64_t, bool, uint64_t>;
 
         enum State : uint32_t
         {
@@ -64,7 +170,17 @@ namespace libsdlgui
             CursorHidden = 0x2
         };
 
+        // the windows in the process by their SDL window id
+        static std::unordered_map<uint32_t, Window*> s_windows;
+
+        // the event pushed to wake the app's loop when a command is posted
+        static uint32_t s_commandEventType;
+
+        // the first exception that left a coroutine on the thread since the last call to Render()
+        static thread_local std::exception_ptr s_taskError;
+
         detail::Flags<State> m_flags;
+        uint32_t m_windowId;
         SDL_Color m_bColor;
         SDL_Color m_fColor;
         SDL_Window* m_window;
@@ -73,34 +189,154 @@ namespace libsdlgui
         std::vector<Control*> m_controls;
         Control* m_pCtrlWithFocus;
         Control* m_pCtrlUnderMouse;
+        Control* m_pCapture;
+        std::vector<Control*> m_modals;
         SDLSubSystem m_subSystem;
         Font* m_pFont;
         std::vector<ControlElapsedTime> m_ctrlsElapsedTime;
+        std::vector<DelayedResume> m_delayedResumes;
+        std::vector<std::coroutine_handle<>> m_suspendedTasks;
+        LatencyHistogram m_frameTimes;
+        LatencyHistogram m_inputLatency;
+        uint64_t m_pendingInputCounter;
+        uint32_t m_pendingInputDelay;
+        RenderOptions m_options;
+        uint64_t m_nextFrame;
+        uint64_t m_lastActivity;
+        TickSource m_tickSource;
+        std::unique_ptr<detail::InputRecorder> m_recorder;
+        detail::HitTestGeometry m_hitTest;
+        std::unordered_map<Control const*, size_t> m_controlIndices;
+        std::map<RunKey, Control*> m_runs;
+        std::unordered_map<Control const*, RunKey> m_runKeys;
+        std::vector<Control*> m_reordered;
+        bool m_orderDirty;
+        bool m_layersSupported;
+        bool m_dirty;
+        bool m_notifyingTimers;
+        std::vector<SDL_Rect> m_damage;
+        std::vector<SDL_Rect> m_frameDamage;
+        std::vector<SDL_Rect> m_occluders;
+        std::map<GlyphAtlasKey, std::unique_ptr<detail::GlyphAtlas>> m_glyphAtlases;
+        SDL_Point m_drawOrigin;
+        SDL_Texture* m_pTarget;
+        SDL_Rect m_clip;
+        bool m_clipEnabled;
+        std::unique_ptr<detail::DisplayList> m_pDisplayList;
+        std::unique_ptr<detail::DisplayList> m_pUploads;
+        detail::DisplayList* m_pRecording;
+        std::unique_ptr<detail::RenderThread> m_renderThread;
+        uint64_t m_frameNumber;
+        mutable detail::TexturePool m_texturePool;
+        detail::CommandQueue m_commands;
+        std::atomic<bool> m_commandEventPosted;
+        std::atomic<size_t> m_backgroundTasks;
 
         // returns true if the cursor is hidden
         bool GetCursorHidden() const { return (m_flags & State::CursorHidden) == State::CursorHidden; }
 
+        // computes the render clip and layer of the control and its descendants
+        void ComputeRenderClips(Control* pControl, const SDL_Rect& parentClip, Control* pLayer);
+
+        // culls the controls that are completely covered by opaque controls above
+        // them.  returns true if the window's background is completely covered.
+        bool CullOccludedControls();
+
+        // appends the control followed by its descendants in the order they were added, so a child is
+        // above its parent and above its older siblings.  descendants with a layer of their own are left out.
+        static void AppendRun(Control* pControl, std::vector<Control*>& controls);
+
+        // puts the controls in draw order and updates the hit-test geometry if required.  controls
+        // whose layer or parent changed are moved with their descendants, only the controls between
+        // their old and new places are renumbered.  adding or removing controls orders all of them.
+        void EnsureOrdered();
+
+        // gets the key of the run that starts with the control
+        static RunKey GetRunKey(Control const* pControl);
+
+        // returns true if the control is drawn into its own layer
+        bool IsLayer(Control* pControl) const;
+
+        // returns true if the control can receive input, i.e. there's no modal control or it's a descendant of the topmost one
+        bool IsInModalScope(Control const* pControl) const;
+
+        // drops the focus, hover and pointer capture of controls that left the modal scope and rebuilds the hit test
+        void ModalScopeChanged();
+
+        // moves the runs of the reordered controls to their new places.  returns false without moving
+        // anything if a run's controls aren't together in the draw order any more, which happens when
+        // a descendant of a reordered control changed its parent or layer too, then the controls are ordered from scratch.
+        bool MoveReordered();
+
         void OnKeyboard(const SDL_KeyboardEvent& keyboardEvent);
         void OnMouseButton(const SDL_MouseButtonEvent& buttonEvent);
         void OnMouseMotion(const SDL_MouseMotionEvent& motionEvent);
         void OnMouseWheel(const SDL_MouseWheelEvent& wheelEvent);
         void OnTextInput(const SDL_TextInputEvent& textEvent);
         void OnWindowResized(const SDL_WindowEvent& windowEvent);
+        void PaceFrame();
+
+        // queues a command posted from any thread and wakes the app's loop if it's waiting for events
+        void PostCommand(const detail::CommandQueue::Key& key, std::function<void()> command);
+
+        // records the control's drawing into its retained list if it was invalidated then
+        // adds the retained list to the frame's list
+        void RenderControl(Control* pControl);
+
+        void RenderControls(Control* pLayer, SDL_Rect const* pDamage);
+        void RenderCopy(const SDLTexture& texture, SDL_Rect const* source, const SDL_Rect& destination);
+
+        // updates the indices and hit-test geometry of the controls from first up to last
+        void RenumberControls(size_t first, size_t last);
+
+        void SetClip(SDL_Rect const* clip);
+        void SetTarget(SDL_Texture* pTexture);
         bool ShouldRender();
+        SDL_Rect ToTarget(const SDL_Rect& rect) const;
+        void TrackInputEvent(const SDL_Event& sdlEvent);
+
+        // hit tests the point and notifies the controls the mouse has left or entered, returns the control under it
+        Control* UpdateControlUnderMouse(const SDL_Point& point);
 
+        bool UpdateLayer(Control* pLayer);
+        void UpdateRenderClips();
+
+        friend SDLTexture detail::AcquireRenderTarget(Window* pWindow, int width, int height);
         friend void detail::AddControl(Window* pWindow, Control* pControl);
+        friend void detail::ControlGeometryChanged(Window* pWindow, Control* pControl);
+        friend void detail::ControlOrderChanged(Window* pWindow, Control* pControl);
+        friend SDLTexture detail::CreateTextureForSurface(Window const* pWindow, SDL_Surface* pSurface);
         friend SDLTexture detail::CreateTextureForText(Window const* pWindow, const std::string& text, Font const* font, const SDL_Color& fgColor, const SDL_Color& bgColor);
         friend SDL_Color detail::GetBackgroundColor(Window const* pWindow);
         friend Font* detail::GetFont(Window const* pWindow);
+        friend detail::GlyphAtlas* detail::GetGlyphAtlas(Window* pWindow, Font const* font, const SDL_Color& fgColor, const SDL_Color& bgColor);
         friend SDL_Color detail::GetForegroundColor(Window const* pWindow);
+        friend Control* detail::GetPointerCapture(Window const* pWindow);
+        friend void detail::PushModal(Window* pWindow, Control* pControl);
         friend void detail::RegisterForElapsedTimeNotification(Window* pWindow, Control* pControl, uint32_t ticks);
         friend void detail::RemoveControl(Window* pWindow, Control* pControl);
+        friend void detail::RemoveModal(Window* pWindow, Control* pControl);
+        friend bool detail::RenderTargetsSupported(Window const* pWindow);
+        friend void detail::ReportTaskError(std::exception_ptr error);
+        friend void detail::ResumeAfter(Window* pWindow, uint32_t ticks, std::coroutine_handle<> handle);
+        friend void detail::ResumeTask(Window* pWindow, std::coroutine_handle<> handle);
+        friend void detail::SetPointerCapture(Window* pWindow, Control* pControl);
+        friend void detail::SuspendTask(Window* pWindow, std::coroutine_handle<> handle);
         friend void detail::UnregisterForElapsedTimeNotification(Window* pWindow, Control* pControl);
+        friend void detail::UpdateTexture(Window const* pWindow, SDL_Texture* pTexture, const SDL_Rect& area, const void* pixels, int pitch);
+        friend void detail::UpdateTextureForText(Window const* pWindow, SDLTexture& texture, const std::string& text, Font const* font, const SDL_Color& fgColor, const SDL_Color& bgColor);
+        friend class detail::RenderTargetHolder;
 
     public:
         Window(const std::string& title, const Dimentions& dimentions, SDL_WindowFlags windowFlags);
+        Window(const std::string& title, const Dimentions& dimentions, SDL_WindowFlags windowFlags, const RenderOptions& options);
         virtual ~Window();
 
+        // sends the event to the window it was sent to, or to every window if it isn't specific to
+        // one.  call it instead of TranslateEvent() when the app has more than one window.  returns
+        // true if the quit event has been posted.
+        static bool DispatchEvent(const SDL_Event& sdlEvent);
+
         // draws a line of the specified color
         void DrawLine(const SDL_Point& p1, const SDL_Point& p2, const SDL_Color& color);
 
@@ -113,29 +349,143 @@ namespace libsdlgui
         // draws the specified texture at the specified location with an optional clipping rectangle
         void DrawTexture(const SDL_Rect& location, const SDLTexture& texture, SDL_Rect const* clip);
 
+        // gets the window with the specified SDL window id, or nullptr if it isn't one of ours
+        static Window* FromId(uint32_t windowId);
+
         // gets the window's dimentions
         Dimentions GetDimentions() const { return m_dims; }
 
+        // gets the histogram of frame durations in microseconds, measured
+        // from the start of Render() until SDL_RenderPresent() returns.  with
+        // RenderOptions::RenderThread the render thread presents and measures the frame,
+        // the frames it has presented are added to the histogram by the next Render().
+        const LatencyHistogram& GetFrameTimeHistogram() const { return m_frameTimes; }
+
+        // gets the histogram of input latencies in microseconds, measured from the
+        // arrival of an input event until the first present that reflects it.  with
+        // a render thread they're added by the next Render() like the frame durations.
+        const LatencyHistogram& GetInputLatencyHistogram() const { return m_inputLatency; }
+
+        // gets the counters of the pool that recycles the textures of the window's controls
+        const TexturePoolStatistics& GetTexturePoolStatistics() const { return m_texturePool.GetStatistics(); }
+
+        // gets the milliseconds until the next elapsed-time notification is due, 0 if the window has
+        // changes waiting to be drawn or commands to run, or -1 if there are no notifications.  an event-driven loop
+        // can pass it to SDL_WaitEventTimeout() so it sleeps until there is something to do.
+        int GetTimeUntilNextTimer() const;
+
+        // gets the current tick count in milliseconds used for elapsed-time notifications
+        uint32_t GetTicks() const { return m_tickSource != nullptr ? m_tickSource() : SDL_GetTicks(); }
+
+        // gets the options the window was created with
+        const RenderOptions& GetRenderOptions() const { return m_options; }
+
+        // gets the SDL window id, which events for this window carry
+        uint32_t GetWindowId() const { return m_windowId; }
+
+        // decodes the image on the task pool then creates a texture from it on the UI thread and passes it
+        // to the callback at the start of a call to Render().  decoding errors are thrown by Render().
+        void LoadImageAsync(const std::filesystem::path& fileName, const ImageLoadedCallback& callback);
+
+        // marks the window as active so adaptive frame pacing runs at the target frame
+        // rate.  input events and timer notifications do this automatically, call it
+        // for animations driven by the app.
+        void NotifyActivity();
+
+        // posts a command from any thread to run on the UI thread at the start of the next call to Render()
+        void Post(std::function<void()> command) { PostCommand(detail::CommandQueue::Key(nullptr, nullptr), std::move(command)); }
+
+        // posts an update of a control's property from any thread, e.g. PostUpdate<&Label::SetText>(pLabel, text).
+        // updates of the same property of the same control that haven't run yet are replaced so only the last
+        // value is applied.  pending updates are discarded when the control is removed from the window.
+        template <auto Setter, typename T, typename Value>
+        void PostUpdate(T* pControl, Value&& value)
+        {
+            PostCommand(detail::CommandQueue::Key(pControl, &detail::UpdateTag<Setter>), [pControl, value = std::forward<Value>(value)]()
+                {
+                    (pControl->*Setter)(value);
+                });
+        }
+
         // removes all controls from the window
         void RemoveAllControls();
 
-        // render the window and its contents
-        void Render();
+        // calls work on the task pool and passes its result to completion on the UI thread at the start of
+        // a call to Render().  an exception thrown by work is rethrown by Render() instead.  work must
+        // return a value and both must be copyable.  the window waits for its work when it's destroyed.
+        template <typename Work, typename Completion>
+        void RunInBackground(Work work, Completion completion)
+        {
+            ++m_backgroundTasks;
+            TaskPool::GetInstance()->Post([this, work, completion]() mutable
+                {
+                    using Result = decltype(work());
+                    std::shared_ptr<Result> pResult;
+                    std::exception_ptr error;
+                    try
+                    {
+                        pResult = std::make_shared<Result>(work());
+                    }
+                    catch (...)
+                    {
+                        error = std::current_exception();
+                    }
+
+                    Post([pResult, error, completion]() mutable
+                        {
+                            if (error != nullptr)
+                                std::rethrow_exception(error);
+
+                            completion(std::move(*pResult));
+                        });
+
+                    --m_backgroundTasks;
+                });
+        }
+
+        // marks the window's content as changed so the next call to Render() draws and presents
+        // it.  Control::Invalidate() does this, call it when the app draws content of its own.
+        void Invalidate() { m_dirty = true; }
+
+        // marks an area of the window as changed.  with the software renderer the next call to
+        // Render() draws and presents only the changed areas, otherwise it redraws the window.
+        void InvalidateRect(const SDL_Rect& rect);
+
+        // render the window and its contents if they've changed since the last present,
+        // then wait as required by the window's frame pacing.
+        RenderStatus Render();
+
+        // clears the frame time and input latency histograms
+        void ResetFrameStatistics();
+
+        // sets the source of the tick count used for elapsed-time notifications.
+        // specify nullptr to restore the default of SDL_GetTicks().
+        void SetTickSource(const TickSource& tickSource) { m_tickSource = tickSource; }
 
         // sets the cursor's hidden state
         void SetCursorHidden(bool hidden);
 
         // sets the window's background color
-        void SetBackgroundColor(const SDL_Color& color) { m_bColor = color; }
+        void SetBackgroundColor(const SDL_Color& color) { m_bColor = color; Invalidate(); }
 
         // sets the window's font
         void SetFont(Font* pFont) { m_pFont = pFont; }
 
         // sets the window's foreground color
-        void SetForegroundColor(const SDL_Color& color) { m_fColor = color; }
+        void SetForegroundColor(const SDL_Color& color) { m_fColor = color; Invalidate(); }
+
+        // destroys the textures held by the window's texture pool until at most maxBytes are held
+        void TrimTexturePool(size_t maxBytes) { m_texturePool.Trim(maxBytes); }
+
+        // starts recording every event passed to TranslateEvent() and every call to
+        // Render() to the specified file.  the recording can be replayed with InputReplay.
+        void StartRecording(const std::filesystem::path& fileName);
+
+        // stops recording events
+        void StopRecording();
 
-        // processes the specified SDL_Event and should be called in the
-        // app's main loop.  returns true if the quit event has been posted.
+        // processes the specified SDL_Event and should be called in the app's main loop.  events
+        // sent to other windows are ignored.  returns true if the quit event has been posted.
         bool TranslateEvent(const SDL_Event& sdlEvent);
     };
 
@@ -16,7 +16,7 @@ namespace libsdlgui::detail
         virtual void RenderImpl();
 
     public:
-        Caret(Window* pWindow, const SDL_Rect& location);
+        Caret(Window* pWindow, const SDL_Rect& location, Control* parent);
 
         // pauses the caret animation
         void PauseAnimation();
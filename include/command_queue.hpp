@@ -0,0 +1,92 @@
+#ifndef COMMANDQUEUE_HPP
+#define COMMANDQUEUE_HPP
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <map>
+#include <stdint.h>
+#include <utility>
+
+namespace libsdlgui
+{
+    // forward declaration to prevent circular reference
+    class Control;
+
+    namespace detail
+    {
+        // commands posted to a window from any thread and run on the UI thread.  posting is lock-free
+        // (an intrusive multiple-producer single-consumer queue), only the UI thread drains it.
+        // commands posted with a key replace any pending command with the same key so only the
+        // last update of a control's property is applied.
+        class CommandQueue
+        {
+        public:
+            using Command = std::function<void()>;
+
+            // identifies a property of a control, commands with equal keys are coalesced
+            using Key = std::pair<Control const*, void const*>;
+
+        private:
+            struct Node
+            {
+                std::atomic<Node*> Next;
+                Command Action;
+                Key CoalesceKey;
+
+                Node() : Next(nullptr), CoalesceKey(nullptr, nullptr) {}
+            };
+
+            // producers exchange the head, the consumer follows the next pointers from the tail
+            std::atomic<Node*> m_head;
+            Node* m_tail;
+            Node m_stub;
+
+            // commands taken from the queue but not yet run, and the latest of each key among them
+            std::deque<Node*> m_pending;
+            std::map<Key, Node*> m_latest;
+
+            // moves the commands posted so far to the pending commands, superseding older updates
+            void Collect();
+
+            // pushes a node, any thread can call it
+            void Push(Node* pNode);
+
+            // pops the oldest posted node, or nullptr if there is none or a post is in progress
+            Node* Pop();
+
+        public:
+            CommandQueue();
+            CommandQueue(const CommandQueue&) = delete;
+            CommandQueue& operator=(const CommandQueue&) = delete;
+            ~CommandQueue();
+
+            // discards the pending updates keyed to the specified control, call it on the UI thread
+            void Cancel(Control const* pControl);
+
+            // discards the pending updates keyed to any control, call it on the UI thread
+            void CancelAll();
+
+            // runs the pending commands in the order they were posted until the budget in
+            // performance counter ticks is spent, at least one command is run.  call it on
+            // the UI thread.  returns true if commands remain.
+            bool Drain(uint64_t budget);
+
+            // returns true if there are commands to run, call it on the UI thread
+            bool HasPending() const;
+
+            // posts a command from any thread
+            void Post(Command command);
+
+            // posts a command from any thread that replaces any pending command with the same key
+            void Post(const Key& key, Command command);
+        };
+
+        // tags that identify a setter for coalescing its updates
+        template <auto Setter>
+        inline const char UpdateTag = 0;
+    }
+
+} // namespace libsdlgui
+
+#endif // COMMANDQUEUE_HPP
@@ -20,6 +20,7 @@ namespace libsdlgui
         class ContentBox : public ListBox
         {
         private:
+            virtual bool ClipsToParentImpl() const;
             virtual bool OnMouseButton(const SDL_MouseButtonEvent&);
 
         public:
@@ -38,7 +39,6 @@ namespace libsdlgui
         virtual bool OnMouseButton(const SDL_MouseButtonEvent& buttonEvent);
         virtual void OnMouseButtonExternal(const SDL_MouseButtonEvent& buttonEvent, Control* pControl);
         virtual void OnMouseWheel(const SDL_MouseWheelEvent& wheelEvent);
-        virtual void OnZOrderChanged();
         virtual void RenderImpl();
 
     public:
@@ -0,0 +1,50 @@
+#ifndef HITTESTGEOMETRY_HPP
+#define HITTESTGEOMETRY_HPP
+
+#include <SDL_rect.h>
+#include <stdint.h>
+#include <vector>
+
+namespace libsdlgui::detail
+{
+    // mirrors the bounds and visibility of a window's controls in contiguous
+    // arrays (structure of arrays) so a point can be tested against several
+    // controls per instruction.  entries are kept in ascending z-order.
+    class HitTestGeometry
+    {
+    private:
+        // number of entries tested per iteration, the arrays are
+        // padded to a multiple of it with entries that never hit.
+        static const size_t BlockSize = 8;
+
+        std::vector<int32_t> m_left;
+        std::vector<int32_t> m_top;
+        std::vector<int32_t> m_right;
+        std::vector<int32_t> m_bottom;
+        std::vector<int32_t> m_visible;
+        size_t m_count;
+
+        int FindTopmostScalar(const SDL_Point& point, size_t end) const;
+
+    public:
+        HitTestGeometry();
+
+        // returns the index of the visible entry with the highest z-order that contains the point, or -1
+        int FindTopmost(const SDL_Point& point) const;
+
+        // gets the number of entries
+        size_t GetCount() const { return m_count; }
+
+        // resizes the geometry to the specified number of entries, new entries are hidden
+        void Resize(size_t count);
+
+        // updates the bounds and visibility of the entry at the specified index
+        void Set(size_t index, const SDL_Rect& bounds, bool isHidden);
+
+        // updates the visibility of the entry at the specified index
+        void SetHidden(size_t index, bool isHidden);
+    };
+
+} // namespace libsdlgui::detail
+
+#endif // HITTESTGEOMETRY_HPP
@@ -0,0 +1,103 @@
+#ifndef INPUTRECORDING_HPP
+#define INPUTRECORDING_HPP
+
+#include "dimentions.hpp"
+#include <filesystem>
+#include <fstream>
+#include <SDL_events.h>
+#include <vector>
+
+namespace libsdlgui
+{
+    // forward declaration
+    class Window;
+
+    namespace detail
+    {
+        // the kinds of records in an input recording
+        enum class InputRecordKind : uint8_t
+        {
+            // the app called Window::Render()
+            Frame = 0,
+
+            // the app called Window::TranslateEvent()
+            Event = 1
+        };
+
+        // writes the events translated by a window and the frames it renders to a compact binary log.
+        //
+        // the log starts with a header of the magic "LSGR", a uint16_t version, a uint16_t
+        // reserved field then the window's width and height as int32_t.  each record is a
+        // uint8_t InputRecordKind followed by a uint32_t tick count relative to the start
+        // of the recording.  event records are followed by a uint16_t size then the bytes
+        // of the SDL_Event member that corresponds to the event's type.  all values are
+        // stored in the host's byte order.
+        class InputRecorder
+        {
+        private:
+            std::ofstream m_stream;
+            uint32_t m_start;
+
+            void WriteHeader(const Dimentions& dimentions);
+            void WriteRecord(InputRecordKind kind, uint32_t ticks);
+
+        public:
+            InputRecorder(const std::filesystem::path& fileName, const Dimentions& dimentions, uint32_t startTicks);
+
+            // records a call to Window::Render()
+            void RecordFrame(uint32_t ticks);
+
+            // records an event passed to Window::TranslateEvent()
+            void RecordEvent(const SDL_Event& sdlEvent, uint32_t ticks);
+        };
+    }
+
+    // controls how fast a recording is replayed
+    enum class ReplaySpeed : uint8_t
+    {
+        // events are dispatched with the same timing as the recording
+        Original,
+
+        // events are dispatched as fast as the window can process them
+        AsFastAsPossible
+    };
+
+    // replays an input recording created with Window::StartRecording() against a window.
+    // during the replay the window's tick source follows the recording so elapsed-time
+    // notifications fire at the same points relative to the input as when it was recorded.
+    // the window needs a renderer but not a display, call UseHeadlessVideo() to replay in CI.
+    class InputReplay
+    {
+    private:
+        struct Record
+        {
+            detail::InputRecordKind Kind;
+            uint32_t Ticks;
+            SDL_Event Event;
+        };
+
+        Dimentions m_dims;
+        std::vector<Record> m_records;
+
+    public:
+        InputReplay(const std::filesystem::path& fileName);
+
+        // gets the number of frames in the recording
+        size_t GetFrameCount() const;
+
+        // gets the dimentions of the window when the recording started
+        Dimentions GetDimentions() const { return m_dims; }
+
+        // replays the recording, returns true if it contained the quit event.
+        // the window should be created with FramePacing::Unlimited when replaying
+        // as fast as possible otherwise each frame will still be paced.
+        bool Run(Window* pWindow, ReplaySpeed speed) const;
+
+        // makes SDL create its windows without a display so a recording can be replayed headless, e.g. in
+        // CI.  call it before SDL is initialized and create the window with RenderOptions::SoftwareRenderer.
+        static void UseHeadlessVideo();
+    };
+
+} // namespace libsdlgui
+
+#endif // INPUTRECORDING_HPP
@@ -0,0 +1,56 @@
+#ifndef LATENCYHISTOGRAM_HPP
+#define LATENCYHISTOGRAM_HPP
+
+#include <array>
+#include <stdint.h>
+
+namespace libsdlgui
+{
+    // histogram of durations in microseconds with HDR-style log-linear buckets.
+    // values are tracked with roughly 3% precision from 1us up to over an hour.
+    class LatencyHistogram
+    {
+    private:
+        // values below this are counted exactly, above it every power
+        // of two range is split into SubBucketHalfCount buckets.
+        static const uint32_t SubBucketCount = 64;
+        static const uint32_t SubBucketHalfCount = SubBucketCount / 2;
+        static const uint32_t BucketCount = SubBucketCount + 26 * SubBucketHalfCount;
+
+        std::array<uint64_t, BucketCount> m_counts;
+        uint64_t m_total;
+        uint64_t m_sum;
+        uint64_t m_min;
+        uint64_t m_max;
+
+        static uint32_t GetBucketIndex(uint64_t value);
+        static uint64_t GetBucketUpperBound(uint32_t index);
+
+    public:
+        LatencyHistogram();
+
+        // gets the number of recorded values
+        uint64_t GetCount() const { return m_total; }
+
+        // gets the largest recorded value
+        uint64_t GetMax() const { return m_max; }
+
+        // gets the mean of the recorded values
+        double GetMean() const;
+
+        // gets the smallest recorded value
+        uint64_t GetMin() const { return m_total > 0 ? m_min : 0; }
+
+        // gets the value below which the specified percentage (0-100) of recorded values fall
+        uint64_t GetPercentile(double percentile) const;
+
+        // records a value
+        void Record(uint64_t microseconds);
+
+        // clears all recorded values
+        void Reset();
+    };
+
+} // namespace libsdlgui
+
+#endif // LATENCYHISTOGRAM_HPP
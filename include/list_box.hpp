@@ -11,6 +11,7 @@ namespace libsdlgui
     class ListBox : public Control
     {
     public:
+        using ItemComparer = std::function<bool(const std::string&, const std::string&)>;
         using SelectionChangedCallback = std::function<void(const std::string&)>;
 
     private:
@@ -20,26 +21,35 @@ namespace libsdlgui
         uint32_t m_highlighted;
         uint32_t m_minVisible;
         uint32_t m_maxVisible;
-        uint32_t m_visStart;
+        uint32_t m_scrollOffset;
         uint32_t m_itemHeight;
         detail::VerticalScrollbar m_vertScrollbar;
         std::vector<std::string> m_items;
         std::vector<std::tuple<SDLTexture, SDLTexture, bool>> m_textures;
+        SDLTexture m_viewport;
+        SDLTexture m_scratch;
+        uint32_t m_viewportOffset;
+        uint32_t m_prefetchFirst;
         SelectionChangedCallback m_callback;
         bool m_scrollRequiredFocus;
         bool m_highlightOnMouseMotion;
+        bool m_viewportValid;
 
         uint32_t GetIndexForMouseLoc(const SDL_Point& mouseLoc);
-        uint32_t GetVisCount() const;
+        const SDLTexture& GetItemTexture(size_t index, bool highlighted);
+        void InvalidateViewport();
+        virtual bool IsOpaqueImpl() const;
         virtual void OnHiddenChanged(bool isHidden);
         virtual void OnKeyboard(const SDL_KeyboardEvent& keyboardEvent);
         virtual void OnLeftClick(const SDL_Point& clickLoc);
         virtual bool OnMouseButton(const SDL_MouseButtonEvent& buttonEvent);
         virtual void OnMouseMotion(const SDL_MouseMotionEvent& motionEvent);
         virtual void OnMouseWheel(const SDL_MouseWheelEvent& wheelEvent);
+        virtual void OnRenderTargetsReset();
         virtual void OnResize(int deltaH, int);
-        virtual void OnZOrderChanged();
+        void PrefetchItems(detail::ScrollDirection direction);
         virtual void RenderImpl();
+        void RenderItems(const SDL_Rect& area);
         void SelectedItemChanged();
         void SetHighlighted(uint32_t index);
 
@@ -60,6 +70,9 @@ namespace libsdlgui
         // Registers a callback to be invoked when the selected item changes.
         // The callback parameter contains the value of the selected item.
         void RegisterForSelectionChangedCallback(const SelectionChangedCallback& callback);
+
+        // sorts the items, the selected item stays selected.  long lists are sorted on the task pool.
+        void SortItems(const ItemComparer& comparer);
     };
 
 } // namespace libsdlgui
@@ -0,0 +1,58 @@
+#ifndef NUMERICLABEL_HPP
+#define NUMERICLABEL_HPP
+
+#include <array>
+#include <charconv>
+#include "control.hpp"
+#include "font.hpp"
+#include "sdl_helpers.hpp"
+#include "text_alignment.hpp"
+
+namespace libsdlgui
+{
+    namespace detail
+    {
+        // forward declaration
+        class GlyphAtlas;
+    }
+
+    // a label that displays a number.  the number is formatted without allocating and drawn
+    // from glyphs rasterized once per font and color, so it can be updated every frame.
+    class NumericLabel : public Control
+    {
+    private:
+        std::array<char, 64> m_buffer;
+        size_t m_length;
+        detail::GlyphAtlas* m_pAtlas;
+        Font* m_pFont;
+        std::string m_suffix;
+        SDLTexture m_suffixTexture;
+        TextAlignment m_alignment;
+
+        virtual bool IsOpaqueImpl() const;
+        virtual void RenderImpl();
+        void SetChars(const char* first, const char* last);
+
+    public:
+        NumericLabel(Window* pWindow, const SDL_Rect& location);
+
+        // sets the alignment of the number within the label
+        void SetAlignment(TextAlignment alignment);
+
+        // sets the font to use for the number and suffix
+        void SetFont(Font* pFont);
+
+        // sets the text displayed after the number (e.g. a unit)
+        void SetSuffix(const std::string& suffix);
+
+        // sets the number to display
+        void SetValue(int64_t value);
+
+        // sets the number to display using the specified format and precision, e.g.
+        // std::chars_format::fixed with a precision of two for prices.
+        void SetValue(double value, std::chars_format format, int precision);
+    };
+
+} // namespace libsdlgui
+
+#endif // NUMERICLABEL_HPP
@@ -0,0 +1,74 @@
+#ifndef RENDEROPTIONS_HPP
+#define RENDEROPTIONS_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace libsdlgui
+{
+    // specifies how a window paces the frames it presents
+    enum class FramePacing : uint8_t
+    {
+        // present as fast as possible, or at the display's refresh rate when vsync is enabled
+        Unlimited,
+
+        // present at the target frame rate
+        Fixed,
+
+        // present at the target frame rate while there is input or animation,
+        // dropping to the idle frame rate once the window has been idle.
+        Adaptive
+    };
+
+    // the result of a call to Window::Render()
+    enum class RenderStatus : uint8_t
+    {
+        // the window's content was drawn and presented
+        Presented,
+
+        // nothing was invalidated since the last present so drawing and presenting were skipped
+        NothingChanged,
+
+        // the window is minimized so nothing was drawn
+        NotVisible
+    };
+
+    // options that control how a window renders and presents its content
+    struct RenderOptions
+    {
+        // synchronize presents with the display's refresh rate
+        bool VSync;
+
+        // draw with SDL's software renderer into the window's surface.  the surface keeps its
+        // content between frames so only the areas that changed are drawn and presented.
+        bool SoftwareRenderer;
+
+        FramePacing Pacing;
+
+        // frames per second for fixed pacing and for adaptive pacing while active
+        uint32_t TargetFrameRate;
+
+        // frames per second for adaptive pacing while idle
+        uint32_t IdleFrameRate;
+
+        // milliseconds without activity before adaptive pacing drops to the idle frame rate
+        uint32_t IdleTimeout;
+
+        // the most memory the window's pool of released textures may use before they're destroyed
+        size_t TexturePoolBytes;
+
+        // microseconds per frame spent running commands posted from other threads, the rest wait for the next frame
+        uint32_t CommandBudget;
+
+        // draw and present on a thread of the window's own.  Render() records the frame and hands it over
+        // so the UI thread doesn't wait for the renderer.  the renderer must support being used from
+        // another thread, such as direct3d11 or software.  the window is always redrawn in full.
+        bool RenderThread;
+
+        RenderOptions() : VSync(false), SoftwareRenderer(false), Pacing(FramePacing::Unlimited), TargetFrameRate(60), IdleFrameRate(4), IdleTimeout(500),
+            TexturePoolBytes(8 * 1024 * 1024), CommandBudget(2000), RenderThread(false) {}
+    };
+
+} // namespace libsdlgui
+
+#endif // RENDEROPTIONS_HPP
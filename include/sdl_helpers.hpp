@@ -12,6 +12,11 @@
 
 namespace libsdlgui
 {
+    namespace detail
+    {
+        // forward declaration
+        class TexturePool;
+    }
 
     // list of SDL subsystems that can be initialized
     enum class SDLSubSystem
@@ -97,24 +102,39 @@ namespace libsdlgui
         SDL_Surface* operator->() const { return m_pSurface; }
     };
 
-    // thin wrapper around an SDL_Texture*
+    // thin wrapper around an SDL_Texture*.  textures acquired from a
+    // detail::TexturePool are returned to it instead of being destroyed.
     class SDLTexture
     {
     private:
         SDL_Texture* m_pTexture;
+        detail::TexturePool* m_pPool;
         int m_width;
         int m_height;
+        int m_capacityWidth;
+        int m_capacityHeight;
         SDLTexture(const SDLTexture&);
 
         void Cleanup();
     public:
-        SDLTexture() : m_pTexture(nullptr), m_width(0), m_height(0) {}
+        SDLTexture() : m_pTexture(nullptr), m_pPool(nullptr), m_width(0), m_height(0), m_capacityWidth(0), m_capacityHeight(0) {}
         SDLTexture(SDL_Texture* pTexture, int width, int height);
+        SDLTexture(SDL_Texture* pTexture, int width, int height, int capacityWidth, int capacityHeight);
+        SDLTexture(SDL_Texture* pTexture, int width, int height, int capacityWidth, int capacityHeight, detail::TexturePool* pPool);
         SDLTexture(SDLTexture&& other);
         ~SDLTexture();
 
+        // gets the allocated size of the texture, its content can be smaller
+        int GetCapacityWidth() const { return m_capacityWidth; }
+        int GetCapacityHeight() const { return m_capacityHeight; }
+
+        // gets the size of the texture's content
         int GetWidth() const { return m_width; }
         int GetHeight() const { return m_height; }
+
+        // sets the size of the texture's content, which must fit within its capacity
+        void SetSize(int width, int height);
+
         operator SDL_Texture* () const { return m_pTexture; }
         SDLTexture& operator=(SDLTexture& rhs);
         SDLTexture& operator=(SDLTexture&& rhs);
@@ -222,6 +242,22 @@ namespace libsdlgui
             (bottom.y + bottom.h) <= (top.y + top.h));
     }
 
+    // returns the intersection of the specified rects, the result is empty if they don't intersect
+    inline SDL_Rect SDLRectIntersection(const SDL_Rect& lhs, const SDL_Rect& rhs)
+    {
+        SDL_Rect result = { 0, 0, 0, 0 };
+        if (SDL_IntersectRect(&lhs, &rhs, &result) == SDL_FALSE)
+            result = { 0, 0, 0, 0 };
+
+        return result;
+    }
+
+    // returns true if the rect has no area
+    inline bool SDLRectEmpty(const SDL_Rect& rect)
+    {
+        return rect.w <= 0 || rect.h <= 0;
+    }
+
     // returns true if the specified points are within rect
     inline bool SDLPointInRect(const SDL_Point& point, const SDL_Rect& rect)
     {
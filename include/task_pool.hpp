@@ -0,0 +1,137 @@
+#ifndef TASKPOOL_HPP
+#define TASKPOOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include "singleton.hpp"
+#include <thread>
+#include <vector>
+
+namespace libsdlgui
+{
+    namespace detail
+    {
+        // a pool of worker threads shared by every window in the process.  each worker has its own
+        // queue of tasks, it runs the newest of its own tasks first and when it runs out it takes the
+        // oldest task of another worker.  tasks posted by threads that aren't workers, such as the UI
+        // thread, go into a shared queue.  tasks must not throw, ParallelFor() and Window::RunInBackground()
+        // pass exceptions on to their caller.
+        class TaskPoolType
+        {
+        public:
+            using Task = std::function<void()>;
+
+            // called with a range [first, last) of the iterations
+            using RangeTask = std::function<void(size_t first, size_t last)>;
+
+        private:
+            friend void Singleton<TaskPoolType>::Initialize();
+            friend void Singleton<TaskPoolType>::Destroy();
+
+            // the fewest elements sorted by each worker when sorting in parallel
+            static const size_t MinSortChunk = 4096;
+
+            struct Worker
+            {
+                std::mutex Lock;
+                std::deque<Task> Tasks;
+                std::thread Thread;
+            };
+
+            // the worker running on the current thread, nullptr for other threads
+            static thread_local Worker* t_pWorker;
+
+            std::vector<std::unique_ptr<Worker>> m_workers;
+            std::mutex m_lock;
+            std::condition_variable m_wake;
+            std::deque<Task> m_shared;
+            std::atomic<size_t> m_queued;
+            std::atomic<size_t> m_nextVictim;
+            bool m_stopping;
+
+            TaskPoolType();
+            ~TaskPoolType();
+
+            // starts the specified number of workers, 0 for one less than the hardware threads
+            void Start(size_t threadCount);
+
+            // runs the queued tasks then stops the workers
+            void Stop();
+
+            // takes a task from the worker's own queue, the shared queue or another worker's queue
+            bool TakeTask(Worker* pWorker, Task& task);
+
+            // wakes an idle worker after a task has been queued
+            void WakeWorker();
+
+            // runs tasks on a worker thread until the pool is stopped
+            void WorkerLoop(Worker* pWorker);
+
+        public:
+            // gets the number of worker threads
+            size_t GetThreadCount() const { return m_workers.size(); }
+
+            // runs body over [begin, end) split into ranges of about grain iterations, 0 picks a grain
+            // that gives each thread a few ranges.  the calling thread runs ranges too and returns once
+            // they're all done.  the first exception thrown by body is rethrown after they're done.
+            void ParallelFor(size_t begin, size_t end, const RangeTask& body, size_t grain = 0);
+
+            // queues a task to run on a worker thread, any thread can call it
+            void Post(Task task);
+
+            // runs one queued task on the calling thread, returns false if there were none
+            bool RunPendingTask();
+
+            // replaces the workers with the specified number, 0 for one less than the hardware threads.
+            // the queued tasks are run first.  don't call it from a task.
+            void SetThreadCount(size_t threadCount);
+
+            // sorts [first, last) by sorting a run per thread in parallel and merging the runs
+            template <typename RandomIt, typename Compare>
+            void Sort(RandomIt first, RandomIt last, Compare compare)
+            {
+                auto count = static_cast<size_t>(last - first);
+                auto runs = std::min(m_workers.size() + 1, count / MinSortChunk);
+                if (runs < 2)
+                {
+                    std::sort(first, last, compare);
+                    return;
+                }
+
+                auto runLength = (count + runs - 1) / runs;
+                ParallelFor(0, runs, [&](size_t firstRun, size_t lastRun)
+                    {
+                        for (auto run = firstRun; run < lastRun; ++run)
+                            std::sort(first + run * runLength, first + std::min((run + 1) * runLength, count), compare);
+                    }, 1);
+
+                // merge neighbouring runs until there is one
+                for (auto width = runLength; width < count; width *= 2)
+                {
+                    auto merges = (count + (2 * width) - 1) / (2 * width);
+                    ParallelFor(0, merges, [&](size_t firstMerge, size_t lastMerge)
+                        {
+                            for (auto merge = firstMerge; merge < lastMerge; ++merge)
+                            {
+                                auto low = merge * 2 * width;
+                                auto middle = std::min(low + width, count);
+                                auto high = std::min(low + (2 * width), count);
+                                if (middle < high)
+                                    std::inplace_merge(first + low, first + middle, first + high, compare);
+                            }
+                        }, 1);
+                }
+            }
+        };
+    }
+
+    using TaskPool = libsdlgui::detail::Singleton<detail::TaskPoolType>;
+
+} // namespace libsdlgui
+
+#endif // TASKPOOL_HPP
@@ -20,6 +20,7 @@ namespace libsdlgui
         size_t m_position;
         int m_clipOffset;
 
+        virtual bool IsOpaqueImpl() const;
         void KeydownBackspace();
         void KeydownDelete();
         void KeydownLeft();
@@ -32,7 +33,6 @@ namespace libsdlgui
         virtual void OnMouseEnter();
         virtual void OnMouseExit();
         virtual void OnTextInput(const SDL_TextInputEvent& textEvent);
-        virtual void OnZOrderChanged();
         virtual void RenderImpl();
 
     public:
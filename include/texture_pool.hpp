@@ -0,0 +1,118 @@
+#ifndef TEXTUREPOOL_HPP
+#define TEXTUREPOOL_HPP
+
+#include <map>
+#include <mutex>
+#include <SDL_render.h>
+#include "sdl_helpers.hpp"
+#include <stdint.h>
+#include <tuple>
+#include <vector>
+
+namespace libsdlgui
+{
+    // counters describing how well a window's texture pool is recycling textures
+    struct TexturePoolStatistics
+    {
+        // textures handed out from the pool
+        uint64_t Reused;
+
+        // textures that had to be created because the pool had none of the right kind
+        uint64_t Created;
+
+        // textures destroyed because the pool was full, trimmed or cleared
+        uint64_t Destroyed;
+
+        // textures currently held by the pool
+        size_t PooledTextures;
+
+        // approximate memory used by the textures held by the pool
+        size_t PooledBytes;
+
+        TexturePoolStatistics() : Reused(0), Created(0), Destroyed(0), PooledTextures(0), PooledBytes(0) {}
+    };
+
+    namespace detail
+    {
+        // recycles textures so controls that frequently replace their textures don't
+        // create and destroy them with the renderer.  textures are bucketed by format,
+        // access and size class, an SDLTexture acquired from the pool returns its
+        // texture to the pool when it's destroyed or assigned over.  when frames are drawn on another
+        // thread released textures are retired until the frames that could refer to them are presented.
+        // the pool is only used on the UI thread, the renderer lock is only held to create and destroy textures
+        // as the render thread may be using the renderer.
+        class TexturePool
+        {
+        private:
+            using Bucket = std::tuple<uint32_t, int, int, int>;
+
+            SDL_Renderer* m_pRenderer;
+            size_t m_maxPooledBytes;
+            std::map<Bucket, std::vector<SDL_Texture*>> m_free;
+            std::vector<std::pair<uint64_t, SDL_Texture*>> m_retired;
+            TexturePoolStatistics m_stats;
+            std::mutex m_rendererLock;
+            uint64_t m_frame;
+            bool m_deferRelease;
+
+            // destroys a texture that isn't pooled
+            void Destroy(SDL_Texture* pTexture);
+
+            // destroys pooled textures until at most maxBytes are held
+            void DestroyUntil(size_t maxBytes);
+
+            // gets the memory used by a texture of the specified format and size
+            static size_t GetTextureBytes(uint32_t format, int width, int height);
+
+            // puts a texture in its bucket or destroys it if the pool is full
+            void Recycle(SDL_Texture* pTexture);
+
+        public:
+            TexturePool();
+            TexturePool(const TexturePool&) = delete;
+            TexturePool& operator=(const TexturePool&) = delete;
+            ~TexturePool();
+
+            // rounds the size up to its size class, classes are a quarter of a power of two apart
+            static int GetSizeClass(int size);
+
+            // gets a texture with room for at least the specified size, reusing a pooled one if possible.
+            // the texture's content size is set to the requested size, its capacity is the size class.
+            SDLTexture Acquire(uint32_t format, int access, int width, int height);
+
+            // destroys all pooled textures
+            void Clear();
+
+            // gets the lock held while the renderer is used, by the pool while it creates or destroys
+            // textures and by whoever draws with the renderer
+            std::mutex& GetRendererLock() { return m_rendererLock; }
+
+            // gets the pool's counters
+            const TexturePoolStatistics& GetStatistics() const { return m_stats; }
+
+            // recycles the retired textures that are no longer used by the presented frames
+            void Reclaim(uint64_t presentedFrame);
+
+            // returns a texture to the pool, it's destroyed if the pool is full
+            void Release(SDL_Texture* pTexture);
+
+            // sets whether released textures are retired until the frame being recorded has been presented
+            void SetDeferRelease(bool deferRelease) { m_deferRelease = deferRelease; }
+
+            // sets the number of the frame being recorded, textures released from now on are retired with it
+            void SetFrame(uint64_t frame) { m_frame = frame; }
+
+            // sets the renderer that creates the pool's textures, clearing the pool if it changes
+            void SetRenderer(SDL_Renderer* pRenderer);
+
+            // sets the most memory the pooled textures may use, pooled textures are destroyed to fit
+            void SetMaxPooledBytes(size_t maxBytes);
+
+            // destroys pooled textures until at most maxBytes are held
+            void Trim(size_t maxBytes);
+        };
+    }
+
+} // namespace libsdlgui
+
+#endif // TEXTUREPOOL_HPP
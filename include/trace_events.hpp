@@ -0,0 +1,60 @@
+#ifndef TRACEEVENTS_HPP
+#define TRACEEVENTS_HPP
+
+#include <atomic>
+#include <filesystem>
+#include <stdint.h>
+
+namespace libsdlgui
+{
+    namespace detail
+    {
+        // true when spans are being recorded
+        extern std::atomic<bool> g_traceEnabled;
+
+        // records a span on the calling thread's ring buffer
+        void RecordTraceSpan(const char* name, const char* category, uint64_t start, uint64_t end);
+
+        // returns the current value of the high resolution counter used for spans
+        uint64_t GetTraceTimestamp();
+
+        // records the lifetime of the object as a span.  the name and
+        // category must point to storage that outlives the next flush.
+        class TraceSpan
+        {
+        private:
+            const char* m_name;
+            const char* m_category;
+            uint64_t m_start;
+
+            TraceSpan(const TraceSpan&) = delete;
+            TraceSpan& operator=(const TraceSpan&) = delete;
+
+        public:
+            TraceSpan(const char* name, const char* category) : m_name(name), m_category(category), m_start(0)
+            {
+                if (g_traceEnabled.load(std::memory_order_relaxed))
+                    m_start = GetTraceTimestamp();
+            }
+
+            ~TraceSpan()
+            {
+                if (m_start != 0)
+                    RecordTraceSpan(m_name, m_category, m_start, GetTraceTimestamp());
+            }
+        };
+    }
+
+    // writes the spans recorded on all threads to the specified file in the chrome
+    // trace_event JSON format (loadable in chrome://tracing or perfetto) then clears them.
+    void FlushTraceEvents(const std::filesystem::path& fileName);
+
+    // returns true if spans are being recorded
+    inline bool GetTraceEnabled() { return detail::g_traceEnabled.load(std::memory_order_relaxed); }
+
+    // starts or stops recording spans.  recording is off by default.
+    void SetTraceEnabled(bool enabled);
+
+} // namespace libsdlgui
+
+#endif // TRACEEVENTS_HPP
@@ -0,0 +1,159 @@
+#ifndef UITASK_HPP
+#define UITASK_HPP
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <stdint.h>
+#include <type_traits>
+#include <utility>
+#include "window.hpp"
+
+namespace libsdlgui
+{
+    // the return type of a coroutine that runs on the UI thread, such as an event callback written as
+    // [this]() -> UiTask { ... }.  the coroutine runs until its first co_await then returns to its caller,
+    // it's resumed on the UI thread by Window::Render() when what it awaits is done.  an exception that
+    // leaves the coroutine ends it and is thrown by the next call to Render().  a coroutine must not
+    // outlive the window or the controls it uses, coroutines still waiting when the window is destroyed
+    // are destroyed without being resumed.
+    //
+    // parameters are copied into the coroutine except references, which refer to the caller's objects
+    // long after the caller has returned.  coroutine lambdas must take their parameters by value, e.g. a
+    // ListBox callback is written as [this](std::string item) -> UiTask rather than taking const std::string&.
+    class UiTask
+    {
+    public:
+        struct promise_type
+        {
+            UiTask get_return_object() { return UiTask(); }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() { detail::ReportTaskError(std::current_exception()); }
+        };
+    };
+
+    namespace detail
+    {
+        // awaitable that resumes the coroutine at the start of the window's next frame
+        class NextFrameAwaiter
+        {
+        private:
+            Window* m_pWindow;
+
+        public:
+            explicit NextFrameAwaiter(Window* pWindow) : m_pWindow(pWindow) {}
+
+            bool await_ready() const { return false; }
+
+            void await_suspend(std::coroutine_handle<> handle)
+            {
+                SuspendTask(m_pWindow, handle);
+                m_pWindow->Post([pWindow = m_pWindow, handle]() { ResumeTask(pWindow, handle); });
+            }
+
+            void await_resume() const {}
+        };
+
+        // awaitable that resumes the coroutine once the number of ticks has elapsed
+        class DelayAwaiter
+        {
+        private:
+            Window* m_pWindow;
+            uint32_t m_ticks;
+
+        public:
+            DelayAwaiter(Window* pWindow, uint32_t ticks) : m_pWindow(pWindow), m_ticks(ticks) {}
+
+            bool await_ready() const { return m_ticks == 0; }
+            void await_suspend(std::coroutine_handle<> handle) { ResumeAfter(m_pWindow, m_ticks, handle); }
+            void await_resume() const {}
+        };
+
+        // awaitable that calls work on the task pool and resumes the coroutine with its result on the UI thread
+        template <typename Work>
+        class BackgroundAwaiter
+        {
+        private:
+            using Result = std::invoke_result_t<Work&>;
+
+            // what the work produced, passed from the pool to the UI thread by value
+            struct Outcome
+            {
+                std::conditional_t<std::is_void_v<Result>, bool, std::optional<Result>> Value;
+                std::exception_ptr Error;
+            };
+
+            Window* m_pWindow;
+            Work m_work;
+            Outcome m_outcome;
+
+        public:
+            BackgroundAwaiter(Window* pWindow, Work work) : m_pWindow(pWindow), m_work(std::move(work)) {}
+
+            bool await_ready() const { return false; }
+
+            void await_suspend(std::coroutine_handle<> handle)
+            {
+                SuspendTask(m_pWindow, handle);
+                m_pWindow->RunInBackground([work = m_work]() mutable
+                    {
+                        Outcome outcome = {};
+                        try
+                        {
+                            if constexpr (std::is_void_v<Result>)
+                                work();
+                            else
+                                outcome.Value.emplace(work());
+                        }
+                        catch (...)
+                        {
+                            outcome.Error = std::current_exception();
+                        }
+
+                        return outcome;
+                    },
+                    [this, handle](Outcome&& outcome)
+                    {
+                        m_outcome = std::move(outcome);
+                        ResumeTask(m_pWindow, handle);
+                    });
+            }
+
+            Result await_resume()
+            {
+                if (m_outcome.Error != nullptr)
+                    std::rethrow_exception(m_outcome.Error);
+
+                if constexpr (!std::is_void_v<Result>)
+                    return std::move(*m_outcome.Value);
+            }
+        };
+    }
+
+    // co_await Background(pWindow, work) calls work on the task pool without blocking the UI thread and
+    // evaluates to its result back on the UI thread.  an exception thrown by work is thrown by the co_await.
+    // work must be copyable.
+    template <typename Work>
+    detail::BackgroundAwaiter<Work> Background(Window* pWindow, Work work)
+    {
+        return detail::BackgroundAwaiter<Work>(pWindow, std::move(work));
+    }
+
+    // co_await Delay(pWindow, ticks) resumes after the number of ticks of the window's tick source
+    // has elapsed, it's checked along with the controls' elapsed-time notifications.
+    inline detail::DelayAwaiter Delay(Window* pWindow, uint32_t ticks)
+    {
+        return detail::DelayAwaiter(pWindow, ticks);
+    }
+
+    // co_await NextFrame(pWindow) resumes at the start of the window's next call to Render()
+    inline detail::NextFrameAwaiter NextFrame(Window* pWindow)
+    {
+        return detail::NextFrameAwaiter(pWindow);
+    }
+
+} // namespace libsdlgui
+
+#endif // UITASK_HPP
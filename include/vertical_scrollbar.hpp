@@ -26,23 +26,34 @@ namespace libsdlgui::detail
         uint32_t m_current;
         uint32_t m_max;
         uint32_t m_min;
-        uint8_t m_largeChange;
-        uint8_t m_smallChange;
+        uint32_t m_largeChange;
+        uint32_t m_smallChange;
+        uint32_t m_pageSize;
+        int m_dragOffset;
+        double m_glidePosition;
+        double m_glideVelocity;
+        uint32_t m_glideTicks;
         ButtonClicked m_held;
         bool m_showSlider;
         bool m_dragSlider;
+        bool m_gliding;
 
         SDL_Rect GetButtonBounds(bool isUp) const;
         ButtonClicked GetButtonClicked(const SDL_Point& clickLoc) const;
         ScrollDirection GetScrollDirForButton(ButtonClicked button);
-        void MoveSlider();
+        void Glide();
+        virtual bool IsOpaqueImpl() const;
+        void LayoutSlider();
         virtual void OnElapsedTime();
         virtual bool OnMouseButton(const SDL_MouseButtonEvent& buttonEvent);
         virtual void OnMouseExit();
         virtual void OnMouseMotion(const SDL_MouseMotionEvent& motionEvent);
         virtual void OnMouseWheel(const SDL_MouseWheelEvent& wheelEvent);
+        virtual void OnResize(int, int);
         virtual void RenderImpl();
         void ScrollContent(ScrollDirection direction, ScrollMagnitude magnitude);
+        void ScrollTo(uint32_t current, ScrollMagnitude magnitude);
+        void StopGliding();
 
     public:
         VerticalScrollbar(Window* pWindow, const SDL_Rect& location, Control* parent);
@@ -51,7 +62,7 @@ namespace libsdlgui::detail
         uint32_t Current() const { return m_current; }
 
         // gets the number of items to scroll for a large change
-        uint8_t LargeChange() const { return m_largeChange; }
+        uint32_t LargeChange() const { return m_largeChange; }
 
         // gets the upper bound of the scrollable range
         uint32_t Maximum() const { return m_max; }
@@ -65,14 +76,24 @@ namespace libsdlgui::detail
         // sets the current position of the scroll slider
         void SetCurrent(uint32_t current);
 
+        // sets the number of items to scroll for a large change
+        void SetLargeChange(uint32_t largeChange) { m_largeChange = largeChange; }
+
         // sets the upper bound of the scrollable range
         void SetMaximum(uint32_t max);
 
         // sets the lower bound of the scrollable range
         void SetMinimum(uint32_t min) { m_min = min; }
 
+        // sets the amount of the scrollable range that's visible at once, the slider is sized
+        // in proportion to it.  specify zero to shrink the slider as the range grows instead.
+        void SetPageSize(uint32_t pageSize);
+
+        // sets the number of items to scroll for a small change, a notch of the mouse wheel glides this far
+        void SetSmallChange(uint32_t smallChange) { m_smallChange = smallChange; }
+
         // gets the number of items to scroll for a small change
-        uint8_t SmallChange() const { return m_smallChange; }
+        uint32_t SmallChange() const { return m_smallChange; }
     };
 
 } // namespace libsdlgui::detail
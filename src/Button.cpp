@@ -7,9 +7,16 @@ namespace libsdlgui
     Button::Button(Window* pWindow, const SDL_Rect& location) :
         Control(pWindow, location)
     {
+        // the button is highlighted while the mouse is over it
+        SetEventInterest(EventInterest::Hover);
         SetDefaultColorScheme();
     }
 
+    bool Button::IsOpaqueImpl() const
+    {
+        return true;
+    }
+
     void Button::OnFocusAcquired()
     {
         SetBorderColor(SDLColor(64, 64, 128, 0));
@@ -92,7 +99,16 @@ namespace libsdlgui
 
     void Button::SetText(const std::string& text, const SDL_Color& fgColor, const SDL_Color& bgColor)
     {
-        SetTexture(detail::CreateTextureForText(GetWindow(), text, detail::GetFont(GetWindow()), fgColor, bgColor));
+        // check the size first so the text can be rendered into the existing texture
+        auto font = detail::GetFont(GetWindow());
+        auto myLoc = GetLocation();
+        if (static_cast<int>(font->GetTextSize(text.c_str())) > myLoc.w)
+            throw std::runtime_error("texture is too wide for button");
+        if (static_cast<int>(font->GetHeight()) > myLoc.h)
+            throw std::runtime_error("texture is too tall for button");
+
+        detail::UpdateTextureForText(GetWindow(), m_texture, text, font, fgColor, bgColor);
+        Invalidate();
     }
 
     void Button::SetTexture(SDLTexture& texture)
@@ -104,6 +120,7 @@ namespace libsdlgui
             throw std::runtime_error("texture is too tall for button");
 
         m_texture = texture;
+        Invalidate();
     }
 
     void Button::SetTexture(SDLTexture&& texture)
@@ -4,9 +4,12 @@
 
 namespace libsdlgui::detail
 {
-    Caret::Caret(Window* pWindow, const SDL_Rect& location) :
-        m_pause(false), Control(pWindow, location)
+    Caret::Caret(Window* pWindow, const SDL_Rect& location, Control* parent) :
+        m_pause(false), Control(pWindow, location, parent)
     {
+        // the caret only blinks, input goes to its containing control
+        SetEventInterest(EventInterest::None);
+
         // caret is hidden until its containing control has focus
         SetHidden(true);
     }
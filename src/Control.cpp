@@ -1,15 +1,25 @@
 #include "stdafx.h"
 #include "control.hpp"
+#include "display_list.hpp"
 #include "sdl_helpers.hpp"
+#include "trace_events.hpp"
 #include "window.hpp"
 
 namespace libsdlgui
 {
+    uint64_t Control::s_nextSequence = 0;
+
     Control::Control(Window* pWindow, const SDL_Rect& location, Control* parent) :
-        m_pWindow(pWindow), m_pParent(parent), m_flags(State::None), m_loc(location), m_borderSize(0), m_zOrder(0)
+        m_pWindow(pWindow), m_pParent(nullptr), m_pRenderLayer(nullptr), m_pDisplayList(std::make_unique<detail::DisplayList>()),
+        m_flags(State::DrawingDirty), m_interest(EventInterest::All), m_loc(location), m_borderSize(0),
+        m_zLayer(ZLayer::Content), m_sequence(s_nextSequence++)
     {
         assert(m_pWindow != nullptr);
         m_borderColor = { 0, 0, 0, 0 };
+        m_renderClip = { 0, 0, 0, 0 };
+
+        if (parent != nullptr)
+            detail::SetParent(this, parent);
 
         // inherit from window
         m_bColor = detail::GetBackgroundColor(m_pWindow);
@@ -20,6 +30,12 @@ namespace libsdlgui
 
     Control::~Control()
     {
+        // detach from the control tree
+        InvalidateAncestors();
+        detail::SetParent(this, nullptr);
+        for (auto child : m_children)
+            child->m_pParent = nullptr;
+
         detail::RemoveControl(m_pWindow, this);
     }
 
@@ -28,6 +44,69 @@ namespace libsdlgui
         return false;
     }
 
+    void Control::CapturePointer()
+    {
+        detail::SetPointerCapture(m_pWindow, this);
+    }
+
+    bool Control::ClipsChildrenImpl() const
+    {
+        return false;
+    }
+
+    bool Control::ClipsToParentImpl() const
+    {
+        return true;
+    }
+
+    bool Control::HasPointerCapture() const
+    {
+        return detail::GetPointerCapture(m_pWindow) == this;
+    }
+
+    void Control::InheritZLayer()
+    {
+        if ((m_flags & State::OwnZLayer) != State::OwnZLayer)
+            return;
+
+        m_flags ^= State::OwnZLayer;
+        PropagateZLayer(m_pParent != nullptr ? m_pParent->m_zLayer : ZLayer::Content);
+        InvalidateAncestors();
+        detail::ControlOrderChanged(m_pWindow, this);
+    }
+
+    void Control::Invalidate()
+    {
+        // harmless if the control isn't cached as a layer
+        m_flags |= State::LayerDirty;
+        m_flags |= State::DrawingDirty;
+        InvalidateAncestors();
+    }
+
+    void Control::InvalidateAncestors()
+    {
+        // anything that affects a layer affects the window's next frame.  drawing is
+        // clipped to the control's location so that's the only area that changes.
+        m_pWindow->InvalidateRect(m_loc);
+
+        // content that pops up outside of its parent isn't part of the parent's layer, and
+        // ancestors that are moving along with this control are invalidated by their own move.
+        for (auto pControl = this; pControl->ClipsToParentImpl() && pControl->m_pParent != nullptr; pControl = pControl->m_pParent)
+        {
+            auto pParent = pControl->m_pParent;
+            if ((pParent->m_flags & State::Translating) == State::Translating)
+                break;
+
+            pParent->m_flags |= State::LayerDirty;
+        }
+    }
+
+    bool Control::IsOpaqueImpl() const
+    {
+        // controls with an opaque background override this so controls beneath them can be culled
+        return false;
+    }
+
     bool Control::LeftMouseButtonDown(const SDL_MouseButtonEvent& buttonEvent)
     {
         // if the left mouse button was pressed return true
@@ -110,6 +189,11 @@ namespace libsdlgui
         // empty
     }
 
+    void Control::OnRenderTargetsReset()
+    {
+        // empty
+    }
+
     void Control::OnResize(int, int)
     {
         // empty
@@ -130,29 +214,71 @@ namespace libsdlgui
         // empty
     }
 
-    void Control::OnZOrderChanged()
+    void Control::PropagateZLayer(ZLayer layer)
     {
-        // empty
+        m_zLayer = layer;
+        for (auto child : m_children)
+        {
+            if ((child->m_flags & State::OwnZLayer) != State::OwnZLayer)
+                child->PropagateZLayer(layer);
+        }
+    }
+
+    void Control::ReleasePointerCapture()
+    {
+        if (HasPointerCapture())
+            detail::SetPointerCapture(m_pWindow, nullptr);
     }
 
     void Control::SetBackgroundColor(const SDL_Color& color)
     {
-        m_bColor = color;
+        if (m_bColor != color)
+        {
+            m_bColor = color;
+            Invalidate();
+        }
     }
 
     void Control::SetBorderColor(const SDL_Color& color)
     {
-        m_borderColor = color;
+        if (m_borderColor != color)
+        {
+            m_borderColor = color;
+            Invalidate();
+        }
     }
 
     void Control::SetBorderSize(uint8_t size)
     {
-        m_borderSize = size;
+        if (m_borderSize != size)
+        {
+            m_borderSize = size;
+            Invalidate();
+        }
+    }
+
+    void Control::SetCacheAsLayer(bool cache)
+    {
+        if (cache && !GetCacheAsLayer())
+        {
+            m_flags |= State::CacheAsLayer;
+            Invalidate();
+        }
+        else if (!cache && GetCacheAsLayer())
+        {
+            m_flags ^= State::CacheAsLayer;
+            m_layer = SDLTexture();
+            Invalidate();
+        }
     }
 
     void Control::SetForegroundColor(const SDL_Color& color)
     {
-        m_fColor = color;
+        if (m_fColor != color)
+        {
+            m_fColor = color;
+            Invalidate();
+        }
     }
 
     void Control::SetHidden(bool isHidden)
@@ -160,11 +286,15 @@ namespace libsdlgui
         if (isHidden && (m_flags & State::Hidden) != State::Hidden)
         {
             m_flags |= State::Hidden;
+            detail::ControlGeometryChanged(m_pWindow, this);
+            Invalidate();
             OnHiddenChanged(true);
         }
         else if (!isHidden && (m_flags & State::Hidden) == State::Hidden)
         {
             m_flags ^= State::Hidden;
+            detail::ControlGeometryChanged(m_pWindow, this);
+            Invalidate();
             OnHiddenChanged(false);
         }
     }
@@ -175,13 +305,35 @@ namespace libsdlgui
         {
             auto oldLoc = m_loc;
             m_loc = location;
+            detail::ControlGeometryChanged(m_pWindow, this);
+
+            // whatever was beneath the control's old location is uncovered
+            m_pWindow->InvalidateRect(oldLoc);
+
+            // a control's own layer is drawn relative to its location so only
+            // a change of size invalidates it, a move only affects its ancestors.
+            if (location.w != oldLoc.w || location.h != oldLoc.h)
+            {
+                Invalidate();
+            }
+            else
+            {
+                // the retained drawing is in window coordinates
+                m_flags |= State::DrawingDirty;
+                InvalidateAncestors();
+            }
 
             // check location
             int deltaX = location.x - oldLoc.x;
             int deltaY = location.y - oldLoc.y;
 
             if (deltaX != 0 || deltaY != 0)
+            {
+                // descendants moved by OnLocationChanged() keep their place within our layer
+                m_flags |= State::Translating;
                 OnLocationChanged(deltaX, deltaY);
+                m_flags ^= State::Translating;
+            }
 
             // check size
             deltaX = location.h - oldLoc.h;
@@ -192,6 +344,19 @@ namespace libsdlgui
         }
     }
 
+    void Control::SetZLayer(ZLayer layer)
+    {
+        if (m_zLayer == layer && (m_flags & State::OwnZLayer) == State::OwnZLayer)
+            return;
+
+        // a control with a layer of its own is ordered apart from its siblings even when the
+        // layer is its parent's.  the window moves it and its descendants before it's next used.
+        m_flags |= State::OwnZLayer;
+        PropagateZLayer(layer);
+        InvalidateAncestors();
+        detail::ControlOrderChanged(m_pWindow, this);
+    }
+
     namespace detail
     {
         bool CanDrag(Control const* pControl)
@@ -199,9 +364,69 @@ namespace libsdlgui
             return pControl->CanDragImpl();
         }
 
-        uint8_t GetZOrder(Control const* pControl)
+        bool ClipsChildren(Control const* pControl)
+        {
+            return pControl->ClipsChildrenImpl();
+        }
+
+        bool ClipsToParent(Control const* pControl)
+        {
+            return pControl->ClipsToParentImpl();
+        }
+
+        void ClearDrawingDirty(Control* pControl)
+        {
+            pControl->m_flags ^= Control::State::DrawingDirty;
+        }
+
+        void ClearLayerDirty(Control* pControl)
+        {
+            pControl->m_flags ^= Control::State::LayerDirty;
+        }
+
+        void ClearMouseDown(Control* pControl)
+        {
+            pControl->m_flags ^= Control::State::MouseDown;
+        }
+
+        DisplayList& GetDisplayList(Control* pControl)
+        {
+            return *pControl->m_pDisplayList;
+        }
+
+        SDLTexture* GetLayer(Control* pControl)
+        {
+            return pControl->GetCacheAsLayer() ? &pControl->m_layer : nullptr;
+        }
+
+        SDL_Rect GetRenderClip(Control const* pControl)
         {
-            return pControl->m_zOrder;
+            return pControl->m_renderClip;
+        }
+
+        Control* GetRenderLayer(Control const* pControl)
+        {
+            return pControl->m_pRenderLayer;
+        }
+
+        bool HasOwnZLayer(Control const* pControl)
+        {
+            return (pControl->m_flags & Control::State::OwnZLayer) == Control::State::OwnZLayer;
+        }
+
+        bool IsDrawingDirty(Control const* pControl)
+        {
+            return (pControl->m_flags & Control::State::DrawingDirty) == Control::State::DrawingDirty;
+        }
+
+        bool IsLayerDirty(Control const* pControl)
+        {
+            return (pControl->m_flags & Control::State::LayerDirty) == Control::State::LayerDirty;
+        }
+
+        bool IsOpaque(Control const* pControl)
+        {
+            return pControl->IsOpaqueImpl();
         }
 
         void NotificationElapsedTime(Control* pControl)
@@ -274,7 +499,8 @@ namespace libsdlgui
             // this behavior is slightly different from desktop window managers
             // but IMO is a reasonable compromise.
             pControl->m_flags ^= Control::State::MouseDown;
-            pControl->OnMouseExit();
+            if (pControl->HasEventInterest(Control::EventInterest::Hover))
+                pControl->OnMouseExit();
         }
 
         void NotificationMouseMotion(Control* pControl, const SDL_MouseMotionEvent& motionEvent)
@@ -287,6 +513,11 @@ namespace libsdlgui
             pControl->OnMouseWheel(wheelEvent);
         }
 
+        void NotificationRenderTargetsReset(Control* pControl)
+        {
+            pControl->OnRenderTargetsReset();
+        }
+
         void NotificationTextInput(Control* pControl, const SDL_TextInputEvent& textEvent)
         {
             pControl->OnTextInput(textEvent);
@@ -301,6 +532,8 @@ namespace libsdlgui
         {
             if (!pControl->GetHidden())
             {
+                // the dynamic type name has static storage so it can be used as the span's name
+                TraceSpan span(typeid(*pControl).name(), "render");
                 pControl->RenderImpl();
 
                 // border drawn last so it overlays the control's content
@@ -309,10 +542,39 @@ namespace libsdlgui
             }
         }
 
-        void SetZOrder(Control* pControl, uint8_t zOrder)
+        void SetParent(Control* pControl, Control* pParent)
+        {
+            if (pControl->m_pParent == pParent)
+                return;
+
+            // the control leaves the layers of its old ancestors and joins those of its new ones
+            pControl->InvalidateAncestors();
+            if (pControl->m_pParent != nullptr)
+            {
+                auto& siblings = pControl->m_pParent->m_children;
+                siblings.erase(std::find(siblings.begin(), siblings.end(), pControl));
+            }
+
+            pControl->m_pParent = pParent;
+            if (pParent != nullptr)
+                pParent->m_children.push_back(pControl);
+
+            // a child is ordered above its parent in the parent's layer unless it has a layer of its own
+            if ((pControl->m_flags & Control::State::OwnZLayer) != Control::State::OwnZLayer)
+                pControl->PropagateZLayer(pParent != nullptr ? pParent->m_zLayer : Control::ZLayer::Content);
+
+            detail::ControlOrderChanged(pControl->m_pWindow, pControl);
+            pControl->InvalidateAncestors();
+        }
+
+        void SetRenderClip(Control* pControl, const SDL_Rect& clip)
+        {
+            pControl->m_renderClip = clip;
+        }
+
+        void SetRenderLayer(Control* pControl, Control* pLayer)
         {
-            pControl->m_zOrder = zOrder;
-            pControl->OnZOrderChanged();
+            pControl->m_pRenderLayer = pLayer;
         }
 
     } // namespace detail
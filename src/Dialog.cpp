@@ -7,21 +7,22 @@ namespace libsdlgui
 {
     Dialog::Dialog(Window* pWindow, const std::string& title, const Dimentions& dimentions) :
         Control(pWindow, SDLRect(0, 0, dimentions.W, dimentions.H + TitleBarHeight)),
-        m_panel(pWindow, SDLRect(0, TitleBarHeight, dimentions.W, dimentions.H)),
-        m_canDrag(false)
+        m_panel(pWindow, SDLRect(0, TitleBarHeight, dimentions.W, dimentions.H), this),
+        m_canDrag(false),
+        m_modal(false)
     {
         m_titleTexture = detail::CreateTextureForText(pWindow, title, detail::GetFont(pWindow), SDLColor(0, 0, 0, 0), SDLColor(255, 255, 255, 0));
+
+        // dragging by the title bar only needs the mouse buttons
+        SetEventInterest(EventInterest::None);
         SetBackgroundColor(SDLColor(128, 128, 128, 0));
         SetBorderColor(SDLColor(255, 255, 255, 0));
         SetBorderSize(1);
         SetHidden(true);
 
-        // the window's z-order is 0, which means all of its controls also have a z-order of 0.
-        // set the dialog above them. we go a bit higher to leave room for things like drop-downs etc.
-        detail::SetZOrder(this, 10);
-
-        // now set the z-order of the panel above the dialog.
-        detail::SetZOrder(&m_panel, detail::GetZOrder(this) + 1);
+        // the dialog and its controls are above the window's content and pop-ups, the
+        // panel is its child so it's above the dialog.
+        SetZLayer(ZLayer::Dialog);
     }
 
     void Dialog::AddControl(Control* pControl)
@@ -34,6 +35,11 @@ namespace libsdlgui
         return m_canDrag;
     }
 
+    bool Dialog::ClipsChildrenImpl() const
+    {
+        return true;
+    }
+
     void Dialog::CenterDialog()
     {
         auto windowDims = GetWindow()->GetDimentions();
@@ -68,9 +74,20 @@ namespace libsdlgui
         return titleBarLoc;
     }
 
+    bool Dialog::IsOpaqueImpl() const
+    {
+        return true;
+    }
+
     void Dialog::OnHiddenChanged(bool isHidden)
     {
         m_panel.SetHidden(isHidden);
+
+        // only a shown dialog restricts the input
+        if (m_modal && isHidden)
+            detail::RemoveModal(GetWindow(), this);
+        else if (m_modal)
+            detail::PushModal(GetWindow(), this);
     }
 
     void Dialog::OnLeftClick(const SDL_Point& clickLoc)
@@ -98,7 +115,11 @@ namespace libsdlgui
             takeFocus = true;
             auto titleLoc = GetTitleBarLoc();
             if (SDLPointInRect(clickLoc, titleLoc) && !SDLPointInRect(clickLoc, closeLoc))
+            {
+                // fast drags leave the title bar behind the mouse
                 m_canDrag = true;
+                CapturePointer();
+            }
         }
         else if (buttonEvent.state == SDL_RELEASED)
         {
@@ -125,4 +146,16 @@ namespace libsdlgui
         detail::DrawX(GetWindow(), GetCloseButtonLoc(), SDLColor(0, 0, 0, 0));
     }
 
+    void Dialog::SetModal(bool modal)
+    {
+        if (m_modal == modal)
+            return;
+
+        m_modal = modal;
+        if (!modal)
+            detail::RemoveModal(GetWindow(), this);
+        else if (!GetHidden())
+            detail::PushModal(GetWindow(), this);
+    }
+
 } // namespace libsdlgui
@@ -11,6 +11,7 @@ namespace libsdlgui
 
     uint32_t Font::GetCharSize(char c)
     {
+        std::lock_guard<std::mutex> lock(m_lock);
         int minx, maxx, miny, maxy, advance;
         auto result = TTF_GlyphMetrics(m_ttf, c, &minx, &maxx, &miny, &maxy, &advance);
         assert(result == 0);
@@ -30,6 +31,7 @@ namespace libsdlgui
 
     uint32_t Font::GetTextSize(const char* text)
     {
+        std::lock_guard<std::mutex> lock(m_lock);
         int w, h;
         auto result = TTF_SizeText(m_ttf, text, &w, &h);
         assert(result == 0);
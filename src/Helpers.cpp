@@ -3,6 +3,34 @@
 
 namespace libsdlgui::detail
 {
+    uint32_t GetEventWindowId(const SDL_Event& sdlEvent)
+    {
+        switch (sdlEvent.type)
+        {
+        case SDL_WINDOWEVENT:
+            return sdlEvent.window.windowID;
+        case SDL_KEYDOWN:
+        case SDL_KEYUP:
+            return sdlEvent.key.windowID;
+        case SDL_TEXTEDITING:
+        case SDL_TEXTINPUT:
+            return sdlEvent.text.windowID;
+        case SDL_MOUSEMOTION:
+            return sdlEvent.motion.windowID;
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP:
+            return sdlEvent.button.windowID;
+        case SDL_MOUSEWHEEL:
+            return sdlEvent.wheel.windowID;
+        }
+
+        // events registered by the app or the library
+        if (sdlEvent.type >= SDL_USEREVENT && sdlEvent.type < SDL_LASTEVENT)
+            return sdlEvent.user.windowID;
+
+        return 0;
+    }
+
     std::string SafeGetEnv(const std::string& name)
     {
         size_t reqCount;
@@ -13,4 +41,36 @@ namespace libsdlgui::detail
         return std::string(buffer);
     }
 
+    void SetEventWindowId(SDL_Event& sdlEvent, uint32_t windowId)
+    {
+        switch (sdlEvent.type)
+        {
+        case SDL_WINDOWEVENT:
+            sdlEvent.window.windowID = windowId;
+            break;
+        case SDL_KEYDOWN:
+        case SDL_KEYUP:
+            sdlEvent.key.windowID = windowId;
+            break;
+        case SDL_TEXTEDITING:
+        case SDL_TEXTINPUT:
+            sdlEvent.text.windowID = windowId;
+            break;
+        case SDL_MOUSEMOTION:
+            sdlEvent.motion.windowID = windowId;
+            break;
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP:
+            sdlEvent.button.windowID = windowId;
+            break;
+        case SDL_MOUSEWHEEL:
+            sdlEvent.wheel.windowID = windowId;
+            break;
+        default:
+            if (sdlEvent.type >= SDL_USEREVENT && sdlEvent.type < SDL_LASTEVENT)
+                sdlEvent.user.windowID = windowId;
+            break;
+        }
+    }
+
 } // namespace libsdlgui::detail
@@ -7,10 +7,17 @@ namespace libsdlgui
     Label::Label(Window* pWindow, const SDL_Rect& location) :
         Control(pWindow, location), m_text("label")
     {
+        SetEventInterest(EventInterest::None);
+
         // default font is inherited from the window
         m_pFont = detail::GetFont(pWindow);
         assert(m_pFont != nullptr);
-        m_texture = detail::CreateTextureForText(pWindow, m_text, m_pFont, GetForegroundColor(), GetBackgroundColor());
+        detail::UpdateTextureForText(pWindow, m_texture, m_text, m_pFont, GetForegroundColor(), GetBackgroundColor());
+    }
+
+    bool Label::IsOpaqueImpl() const
+    {
+        return true;
     }
 
     void Label::RenderImpl()
@@ -21,7 +28,11 @@ namespace libsdlgui
 
     void Label::SetAlignment(TextAlignment alignment)
     {
-        m_alignment = alignment;
+        if (alignment != m_alignment)
+        {
+            m_alignment = alignment;
+            Invalidate();
+        }
     }
 
     void Label::SetFont(Font* pFont)
@@ -29,7 +40,8 @@ namespace libsdlgui
         if (pFont != m_pFont)
         {
             m_pFont = pFont;
-            m_texture = detail::CreateTextureForText(GetWindow(), m_text, m_pFont, GetForegroundColor(), GetBackgroundColor());
+            detail::UpdateTextureForText(GetWindow(), m_texture, m_text, m_pFont, GetForegroundColor(), GetBackgroundColor());
+            Invalidate();
         }
     }
 
@@ -38,7 +50,8 @@ namespace libsdlgui
         if (text != m_text)
         {
             m_text = text;
-            m_texture = detail::CreateTextureForText(GetWindow(), m_text, m_pFont, GetForegroundColor(), GetBackgroundColor());
+            detail::UpdateTextureForText(GetWindow(), m_texture, m_text, m_pFont, GetForegroundColor(), GetBackgroundColor());
+            Invalidate();
         }
     }
 
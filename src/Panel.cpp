@@ -4,10 +4,10 @@
 
 namespace libsdlgui
 {
-    Panel::Panel(Window* pWindow, const SDL_Rect& location) :
-        Control(pWindow, location)
+    Panel::Panel(Window* pWindow, const SDL_Rect& location, Control* parent) :
+        Control(pWindow, location, parent)
     {
-        // empty
+        SetEventInterest(EventInterest::None);
     }
 
     void Panel::AddControl(Control* pControl)
@@ -16,22 +16,20 @@ namespace libsdlgui
         if (!SDLRectOcclusion(GetLocation(), pControl->GetLocation()))
             throw new std::runtime_error("control is not within bounds of the panel");
 
+        // being a child places the control above the panel
         m_controls.push_back(pControl);
-
-        // place the control just above the panel
-        detail::SetZOrder(pControl, detail::GetZOrder(this) + 1);
-
-        // sort the controls in ascending z-order
-        std::sort(m_controls.begin(), m_controls.end(), [](Control* lhs, Control* rhs)
-            {
-                return detail::GetZOrder(lhs) < detail::GetZOrder(rhs);
-            });
+        detail::SetParent(pControl, this);
 
         // if the panel is hidden then hide the control too
         if (GetHidden())
             pControl->SetHidden(true);
     }
 
+    bool Panel::ClipsChildrenImpl() const
+    {
+        return true;
+    }
+
     void Panel::OnHiddenChanged(bool isHidden)
     {
         for (auto& control : m_controls)
@@ -49,12 +47,6 @@ namespace libsdlgui
         }
     }
 
-    void Panel::OnZOrderChanged()
-    {
-        for (auto& control : m_controls)
-            detail::SetZOrder(control, detail::GetZOrder(this) + 1);
-    }
-
     void Panel::RenderImpl()
     {
         // empty
@@ -1,14 +1,77 @@
 #include "stdafx.h"
 #include "control.hpp"
 #include "cursor_manager.hpp"
+#include "display_list.hpp"
 #include "exceptions.hpp"
 #include "font_manager.hpp"
+#include "glyph_atlas.hpp"
+#include "helpers.hpp"
+#include "input_recording.hpp"
+#include "raster_cache.hpp"
+#include "render_thread.hpp"
+#include "task_pool.hpp"
+#include "trace_events.hpp"
 #include "window.hpp"
 
 namespace libsdlgui
 {
+    namespace
+    {
+        // the most opaque regions tracked when culling occluded controls
+        const size_t MaxOccluders = 32;
+
+        // the most separate areas drawn by a partial frame, further damage is merged into the last
+        const size_t MaxDamageRects = 8;
+
+        // returns true if rect is completely covered by the union of the occluders starting at first
+        bool IsOccluded(const SDL_Rect& rect, const std::vector<SDL_Rect>& occluders, size_t first)
+        {
+            for (auto i = first; i < occluders.size(); ++i)
+            {
+                auto overlap = SDLRectIntersection(rect, occluders[i]);
+                if (SDLRectEmpty(overlap))
+                    continue;
+
+                if (SDLRectOcclusion(occluders[i], rect))
+                    return true;
+
+                // the parts of rect outside of this occluder must be covered by the ones after it
+                SDL_Rect remainder[4] =
+                {
+                    { rect.x, rect.y, rect.w, overlap.y - rect.y },
+                    { rect.x, overlap.y + overlap.h, rect.w, (rect.y + rect.h) - (overlap.y + overlap.h) },
+                    { rect.x, overlap.y, overlap.x - rect.x, overlap.h },
+                    { overlap.x + overlap.w, overlap.y, (rect.x + rect.w) - (overlap.x + overlap.w), overlap.h }
+                };
+
+                for (auto& part : remainder)
+                {
+                    if (!SDLRectEmpty(part) && !IsOccluded(part, occluders, i + 1))
+                        return false;
+                }
+
+                return true;
+            }
+
+            return false;
+        }
+    }
+
+    std::unordered_map<uint32_t, Window*> Window::s_windows;
+    uint32_t Window::s_commandEventType = 0;
+    thread_local std::exception_ptr Window::s_taskError;
+
     Window::Window(const std::string& title, const Dimentions& dimentions, SDL_WindowFlags windowFlags) :
-        m_flags(State::None), m_dims(dimentions), m_pCtrlWithFocus(nullptr), m_pCtrlUnderMouse(nullptr), m_subSystem(SDLSubSystem::Video), m_pFont(nullptr)
+        Window(title, dimentions, windowFlags, RenderOptions())
+    {
+        // empty
+    }
+
+    Window::Window(const std::string& title, const Dimentions& dimentions, SDL_WindowFlags windowFlags, const RenderOptions& options) :
+        m_flags(State::None), m_windowId(0), m_dims(dimentions), m_pCtrlWithFocus(nullptr), m_pCtrlUnderMouse(nullptr), m_pCapture(nullptr), m_subSystem(SDLSubSystem::Video), m_pFont(nullptr),
+        m_pendingInputCounter(0), m_pendingInputDelay(0), m_options(options), m_nextFrame(0),
+        m_orderDirty(false), m_dirty(true), m_notifyingTimers(false), m_drawOrigin({ 0, 0 }), m_pTarget(nullptr), m_clip({ 0, 0, 0, 0 }), m_clipEnabled(false),
+        m_pDisplayList(std::make_unique<detail::DisplayList>()), m_pUploads(std::make_unique<detail::DisplayList>()), m_pRecording(m_pDisplayList.get()), m_frameNumber(0), m_commandEventPosted(false), m_backgroundTasks(0)
     {
         m_window = SDL_CreateWindow(title.c_str(), SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED,
             m_dims.W, m_dims.H, windowFlags);
@@ -16,10 +79,24 @@ namespace libsdlgui
         if (m_window == nullptr)
             throw SDLException("SDL_CreateWindow failed with error '" + SDLGetError() + "'.");
 
-        m_renderer = SDL_CreateRenderer(m_window, -1, SDL_RENDERER_ACCELERATED);
+        m_windowId = SDL_GetWindowID(m_window);
+
+        uint32_t rendererFlags = SDL_RENDERER_ACCELERATED;
+        if (m_options.SoftwareRenderer)
+            rendererFlags = SDL_RENDERER_SOFTWARE;
+        else if (m_options.VSync)
+            rendererFlags |= SDL_RENDERER_PRESENTVSYNC;
+
+        m_renderer = SDL_CreateRenderer(m_window, -1, rendererFlags);
         if (m_renderer == nullptr)
             throw SDLException("SDL_CreateRenderer failed with error '" + SDLGetError() + "'.");
 
+        // without render targets controls cached as layers are drawn directly
+        m_layersSupported = SDL_RenderTargetSupported(m_renderer) == SDL_TRUE;
+
+        m_texturePool.SetRenderer(m_renderer);
+        m_texturePool.SetMaxPooledBytes(m_options.TexturePoolBytes);
+
         if ((windowFlags & SDL_WINDOW_MINIMIZED) == SDL_WINDOW_MINIMIZED)
             m_flags |= State::Minimized;
 
@@ -30,41 +107,191 @@ namespace libsdlgui
         // set default draw color
         SDL_SetRenderDrawColor(m_renderer, m_bColor.r, m_bColor.g, m_bColor.b, m_bColor.a);
 
+        // fonts and rasterized text are shared by all of the windows
         detail::CursorManager::Initialize();
         FontManager::Initialize();
+        detail::RasterCache::Initialize();
+        TaskPool::Initialize();
+        s_windows[m_windowId] = this;
+
+        if (s_commandEventType == 0)
+        {
+            s_commandEventType = SDL_RegisterEvents(1);
+            if (s_commandEventType == static_cast<uint32_t>(-1))
+                throw SDLException("SDL_RegisterEvents failed with error '" + SDLGetError() + "'.");
+        }
+
+        m_lastActivity = SDL_GetPerformanceCounter();
 
         SDL_StopTextInput();
         m_pFont = FontManager::GetInstance()->GetOrLoadFont("consola", 16);
+
+        // textures released by controls might still be drawn by frames the render thread hasn't presented
+        if (m_options.RenderThread)
+        {
+            m_texturePool.SetDeferRelease(true);
+            m_texturePool.SetFrame(m_frameNumber + 1);
+            m_renderThread = std::make_unique<detail::RenderThread>(m_renderer, m_texturePool.GetRendererLock());
+        }
     }
 
     Window::~Window()
     {
+        // the work started by RunInBackground() posts its result to us
+        while (m_backgroundTasks != 0)
+        {
+            if (!TaskPool::GetInstance()->RunPendingTask())
+                std::this_thread::yield();
+        }
+
+        // coroutines waiting for a delay, the next frame or background work will never be resumed
+        for (auto& delayed : m_delayedResumes)
+            std::get<0>(delayed).destroy();
+
+        for (auto& handle : m_suspendedTasks)
+            handle.destroy();
+
+        // the last frame is presented before the textures it uses are destroyed
+        m_renderThread.reset();
+
+        // the atlases' and pool's textures must be destroyed before the renderer
+        m_glyphAtlases.clear();
+        m_texturePool.SetRenderer(nullptr);
+        s_windows.erase(m_windowId);
+
+        // tasks can rasterize text and the rasterized text refers to the fonts
+        TaskPool::Destroy();
+        detail::RasterCache::Destroy();
         detail::CursorManager::Destroy();
         FontManager::Destroy();
         SDL_DestroyRenderer(m_renderer);
         SDL_DestroyWindow(m_window);
     }
 
+    void Window::AppendRun(Control* pControl, std::vector<Control*>& controls)
+    {
+        std::vector<Control*> pending(1, pControl);
+        while (!pending.empty())
+        {
+            pControl = pending.back();
+            pending.pop_back();
+            controls.push_back(pControl);
+
+            auto& children = pControl->GetChildren();
+            for (auto iter = children.rbegin(); iter != children.rend(); ++iter)
+            {
+                if (!detail::HasOwnZLayer(*iter))
+                    pending.push_back(*iter);
+            }
+        }
+    }
+
+    void Window::ComputeRenderClips(Control* pControl, const SDL_Rect& parentClip, Control* pLayer)
+    {
+        auto windowBounds = SDLRect(0, 0, m_dims.W, m_dims.H);
+
+        // content that pops up outside of its parent is drawn to the window, and so are its descendants
+        auto baseClip = parentClip;
+        if (!detail::ClipsToParent(pControl))
+        {
+            baseClip = windowBounds;
+            pLayer = nullptr;
+        }
+
+        auto location = pControl->GetLocation();
+        auto clip = SDLRectIntersection(baseClip, location);
+        if (SDLRectEmpty(clip))
+            return;
+
+        detail::SetRenderClip(pControl, clip);
+        detail::SetRenderLayer(pControl, pLayer);
+
+        // descendants of a control that doesn't clip its children
+        // can draw anywhere the control itself is allowed to.
+        auto childClip = detail::ClipsChildren(pControl) ? clip : baseClip;
+        if (IsLayer(pControl))
+        {
+            // the layer holds the whole subtree, even the parts outside of
+            // the window, so it can be moved without being redrawn.
+            childClip = location;
+            pLayer = pControl;
+        }
+
+        for (auto child : pControl->GetChildren())
+            ComputeRenderClips(child, childClip, pLayer);
+    }
+
+    bool Window::CullOccludedControls()
+    {
+        detail::TraceSpan span("Window::CullOccludedControls", "frame");
+        m_occluders.clear();
+
+        // walk down from the topmost control accumulating the regions covered by opaque controls
+        for (auto iter = m_controls.rbegin(); iter != m_controls.rend(); ++iter)
+        {
+            auto control = *iter;
+            auto clip = detail::GetRenderClip(control);
+            if (SDLRectEmpty(clip) || detail::GetRenderLayer(control) != nullptr || control->GetHidden())
+                continue;
+
+            if (IsOccluded(clip, m_occluders, 0))
+            {
+                detail::SetRenderClip(control, SDLRect(0, 0, 0, 0));
+                continue;
+            }
+
+            // layers are filled with their background so they're opaque too
+            if ((detail::IsOpaque(control) || IsLayer(control)) && m_occluders.size() < MaxOccluders)
+                m_occluders.push_back(clip);
+        }
+
+        return IsOccluded(SDLRect(0, 0, m_dims.W, m_dims.H), m_occluders, 0);
+    }
+
+    bool Window::DispatchEvent(const SDL_Event& sdlEvent)
+    {
+        auto windowId = detail::GetEventWindowId(sdlEvent);
+        if (windowId != 0)
+        {
+            // events for windows that aren't ours (or were just destroyed) are dropped
+            auto pWindow = FromId(windowId);
+            return pWindow != nullptr && pWindow->TranslateEvent(sdlEvent);
+        }
+
+        // the app can create or destroy windows in response to an event so walk a copy of the ids
+        std::vector<uint32_t> windowIds;
+        windowIds.reserve(s_windows.size());
+        for (auto& window : s_windows)
+            windowIds.push_back(window.first);
+
+        bool quit = false;
+        for (auto id : windowIds)
+        {
+            auto pWindow = FromId(id);
+            if (pWindow != nullptr)
+                quit |= pWindow->TranslateEvent(sdlEvent);
+        }
+
+        return quit;
+    }
+
     void Window::DrawLine(const SDL_Point& p1, const SDL_Point& p2, const SDL_Color& color)
     {
-        SDLColorHolder colorHolder(m_renderer, color);
-        SDL_RenderDrawLine(m_renderer, p1.x, p1.y, p2.x, p2.y);
+        m_pRecording->DrawLine(SDLPoint(p1.x - m_drawOrigin.x, p1.y - m_drawOrigin.y), SDLPoint(p2.x - m_drawOrigin.x, p2.y - m_drawOrigin.y), color);
     }
 
     void Window::DrawRectangle(const SDL_Rect& location, const SDL_Color& color, uint8_t thickness)
     {
         assert(thickness > 0);
-        // must preserve previous draw color
-        SDLColorHolder colorHolder(m_renderer, color);
 
         if (thickness == UINT8_MAX)
         {
-            SDL_RenderFillRect(m_renderer, &location);
+            m_pRecording->FillRect(ToTarget(location), color);
         }
         else
         {
             // create a copy of location so we can modify it
-            auto myLoc = location;
+            auto myLoc = ToTarget(location);
             for (uint8_t i = 0; i < thickness; ++i)
             {
                 myLoc.x = myLoc.x + i;
@@ -72,7 +299,7 @@ namespace libsdlgui
                 myLoc.w = myLoc.w - i * 2;
                 myLoc.h = myLoc.h - i * 2;
 
-                SDL_RenderDrawRect(m_renderer, &myLoc);
+                m_pRecording->DrawRect(myLoc, color);
             }
         }
     }
@@ -121,12 +348,12 @@ namespace libsdlgui
 
         if (texture.GetWidth() == location.w && texture.GetHeight() == location.h)
         {
-            SDL_RenderCopy(m_renderer, texture, nullptr, &location);
+            RenderCopy(texture, nullptr, location);
         }
         else if (texture.GetWidth() < location.w && texture.GetHeight() < location.h)
         {
             SDL_Rect myLoc = { location.x + xOffset, location.y + yOffset, texture.GetWidth(), texture.GetHeight() };
-            SDL_RenderCopy(m_renderer, texture, nullptr, &myLoc);
+            RenderCopy(texture, nullptr, myLoc);
         }
         else
         {
@@ -159,23 +386,92 @@ namespace libsdlgui
                 myLoc.h = texture.GetHeight();
             }
 
-            SDL_RenderCopy(m_renderer, texture, &clip, &myLoc);
+            RenderCopy(texture, &clip, myLoc);
         }
     }
 
     void Window::DrawTexture(const SDL_Rect& location, const SDLTexture& texture, SDL_Rect const* clip)
     {
-        SDL_RenderCopy(m_renderer, texture, clip, &location);
+        RenderCopy(texture, clip, location);
+    }
+
+    void Window::EnsureOrdered()
+    {
+        if (!m_orderDirty && !m_reordered.empty() && !MoveReordered())
+            m_orderDirty = true;
+
+        m_reordered.clear();
+        if (!m_orderDirty)
+            return;
+
+        // the controls without a parent and those with a layer of their own start the runs of controls
+        // in draw order, descendants with a layer of their own are in runs of their own
+        m_runs.clear();
+        m_runKeys.clear();
+        for (auto control : m_controls)
+        {
+            if (control->GetParent() != nullptr && !detail::HasOwnZLayer(control))
+                continue;
+
+            auto key = GetRunKey(control);
+            m_runs.emplace(key, control);
+            m_runKeys.emplace(control, key);
+        }
+
+        std::vector<Control*> ordered;
+        ordered.reserve(m_controls.size());
+        for (auto& run : m_runs)
+            AppendRun(run.second, ordered);
+
+        assert(ordered.size() == m_controls.size());
+        m_controls.swap(ordered);
+
+        m_controlIndices.clear();
+        m_hitTest.Resize(m_controls.size());
+        RenumberControls(0, m_controls.size());
+        m_orderDirty = false;
+    }
+
+    Window* Window::FromId(uint32_t windowId)
+    {
+        auto iter = s_windows.find(windowId);
+        return iter != s_windows.end() ? iter->second : nullptr;
     }
 
     void Window::OnKeyboard(const SDL_KeyboardEvent& keyboardEvent)
     {
-        if (m_pCtrlWithFocus != nullptr)
+        if (m_pCtrlWithFocus != nullptr && m_pCtrlWithFocus->HasEventInterest(Control::EventInterest::Keyboard))
             detail::NotificationKeyboard(m_pCtrlWithFocus, keyboardEvent);
     }
 
     void Window::OnMouseButton(const SDL_MouseButtonEvent& buttonEvent)
     {
+        // the control that captured the pointer gets the buttons wherever the mouse is
+        if (m_pCapture != nullptr)
+        {
+            auto pControl = m_pCapture;
+            auto point = SDLPoint(buttonEvent.x, buttonEvent.y);
+            if (buttonEvent.state == SDL_RELEASED)
+            {
+                detail::SetPointerCapture(this, nullptr);
+
+                // releasing the button away from the control isn't a click
+                if (!SDLPointInRect(point, pControl->GetLocation()))
+                    detail::ClearMouseDown(pControl);
+            }
+
+            detail::NotificationMouseButton(pControl, buttonEvent);
+
+            // the controls the mouse moved over meanwhile weren't notified
+            if (m_pCapture == nullptr)
+            {
+                EnsureOrdered();
+                UpdateControlUnderMouse(point);
+            }
+
+            return;
+        }
+
         // if a control has focus and a click happens outside of that control
         // we need to send it a notification.  if the click happens on another
         // control pass the pointer to that control.  only do this when the
@@ -183,41 +479,34 @@ namespace libsdlgui
         bool notifyCtrl = buttonEvent.state == SDL_PRESSED;
         Control* pClickedCtrl = nullptr;
 
-        // must iterate in descending z-order
-        for (auto i = static_cast<int>(m_controls.size()) - 1; i > -1; --i)
+        // find the topmost control that was clicked on then dispatch the event
+        EnsureOrdered();
+        auto index = m_hitTest.FindTopmost(SDLPoint(buttonEvent.x, buttonEvent.y));
+        if (index > -1)
         {
-            if (m_controls[i]->GetHidden())
-                continue;
-
-            // find the control that was clicked on then dispatch the event
-            auto clickPoint = SDLPoint(buttonEvent.x, buttonEvent.y);
-            auto controlLoc = m_controls[i]->GetLocation();
-            if (SDLPointInRect(clickPoint, controlLoc))
+            // the click can open a modal control that excludes the clicked one
+            auto pControl = m_controls[index];
+            if (detail::NotificationMouseButton(pControl, buttonEvent) && IsInModalScope(pControl))
             {
-                if (detail::NotificationMouseButton(m_controls[i], buttonEvent))
+                // remove focus from the previous control and give it to the selected one
+                if (m_pCtrlWithFocus != nullptr && pControl != m_pCtrlWithFocus)
+                    detail::NotificationFocusLost(m_pCtrlWithFocus);
+
+                // if this control already has focus don't notify it again
+                if (pControl != m_pCtrlWithFocus)
                 {
-                    // remove focus from the previous control and give it to the selected one
-                    if (m_pCtrlWithFocus != nullptr && m_controls[i] != m_pCtrlWithFocus)
-                        detail::NotificationFocusLost(m_pCtrlWithFocus);
-
-                    // if this control already has focus don't notify it again
-                    if (m_controls[i] != m_pCtrlWithFocus)
-                    {
-                        m_pCtrlWithFocus = m_controls[i];
-                        detail::NotificationFocusAcquired(m_pCtrlWithFocus);
-                    }
-
-                    // a control that took focus was clicked, no need to notify
-                    // the previous control as it would have received a notification
-                    // that it lost focus.
-                    notifyCtrl = false;
+                    m_pCtrlWithFocus = pControl;
+                    detail::NotificationFocusAcquired(m_pCtrlWithFocus);
                 }
 
-                // remember the control that was clicked but did not take focus
-                pClickedCtrl = m_controls[i];
-
-                break;
+                // a control that took focus was clicked, no need to notify
+                // the previous control as it would have received a notification
+                // that it lost focus.
+                notifyCtrl = false;
             }
+
+            // remember the control that was clicked but did not take focus
+            pClickedCtrl = pControl;
         }
 
         if (m_pCtrlWithFocus != nullptr && notifyCtrl)
@@ -240,106 +529,707 @@ namespace libsdlgui
             m_pCtrlWithFocus->SetLocation(controlLoc);
         }
 
-        bool isOverControl = false;
-        // must iterate in descending z-order
-        for (auto i = static_cast<int>(m_controls.size()) - 1; i > -1; --i)
+        // the control that captured the pointer gets the motion without hit testing
+        if (m_pCapture != nullptr)
         {
-            if (m_controls[i]->GetHidden())
-                continue;
+            if (m_pCapture->HasEventInterest(Control::EventInterest::MouseMotion))
+                detail::NotificationMouseMotion(m_pCapture, motionEvent);
 
-            auto clickPoint = SDLPoint(motionEvent.x, motionEvent.y);
-            auto controlLoc = m_controls[i]->GetLocation();
-            if (SDLPointInRect(clickPoint, controlLoc))
-            {
-                // notify the previous control the mouse has left it
-                if (m_pCtrlUnderMouse != nullptr && m_pCtrlUnderMouse != m_controls[i])
-                    detail::NotificationMouseExit(m_pCtrlUnderMouse);
-
-                // if this control is already under the mouse don't notify it again
-                if (m_pCtrlUnderMouse != m_controls[i])
-                {
-                    m_pCtrlUnderMouse = m_controls[i];
-                    detail::NotificationMouseEnter(m_pCtrlUnderMouse);
-                }
-
-                detail::NotificationMouseMotion(m_pCtrlUnderMouse, motionEvent);
-                isOverControl = true;
-
-                // mouse can't be over more than one control so exit
-                break;
-            }
+            return;
         }
 
-        // mouse is no longer over any control, if it was earlier
-        // then notify that control that it has exited it.
-        if (!isOverControl && m_pCtrlUnderMouse != nullptr)
-        {
-            detail::NotificationMouseExit(m_pCtrlUnderMouse);
-            m_pCtrlUnderMouse = nullptr;
-        }
+        // mouse can't be over more than one control so only the topmost is notified
+        EnsureOrdered();
+        auto pControl = UpdateControlUnderMouse(SDLPoint(motionEvent.x, motionEvent.y));
+        if (pControl != nullptr && pControl->HasEventInterest(Control::EventInterest::MouseMotion))
+            detail::NotificationMouseMotion(pControl, motionEvent);
     }
 
     void Window::OnMouseWheel(const SDL_MouseWheelEvent& wheelEvent)
     {
-        if (m_pCtrlUnderMouse != nullptr)
-            detail::NotificationMouseWheel(m_pCtrlUnderMouse, wheelEvent);
+        auto pControl = m_pCapture != nullptr ? m_pCapture : m_pCtrlUnderMouse;
+        if (pControl != nullptr && pControl->HasEventInterest(Control::EventInterest::MouseWheel))
+            detail::NotificationMouseWheel(pControl, wheelEvent);
     }
 
     void Window::OnTextInput(const SDL_TextInputEvent& textEvent)
     {
         // should have a control with focus (e.g. a text box)
         assert(m_pCtrlWithFocus != nullptr);
-        detail::NotificationTextInput(m_pCtrlWithFocus, textEvent);
+        if (m_pCtrlWithFocus->HasEventInterest(Control::EventInterest::TextInput))
+            detail::NotificationTextInput(m_pCtrlWithFocus, textEvent);
     }
 
     void Window::OnWindowResized(const SDL_WindowEvent& windowEvent)
     {
         // resizing the window creates a new rendering context
         // which requires the rendering surface to be cleared.
-        SDL_RenderClear(m_renderer);
+        // the render thread's next frame is a full one that does it.
+        if (m_renderThread == nullptr)
+            SDL_RenderClear(m_renderer);
 
         // update dimentions
         m_dims.W = windowEvent.data1;
         m_dims.H = windowEvent.data2;
+        Invalidate();
 
         // notify all controls of the change
         for (auto control : m_controls)
             detail::NotificationWindowChanged(control);
     }
 
+    Window::RunKey Window::GetRunKey(Control const* pControl)
+    {
+        auto layer = pControl->GetZLayer();
+        auto pRoot = pControl;
+        for (auto pAncestor = pControl->GetParent(); pAncestor != nullptr; pAncestor = pAncestor->GetParent())
+        {
+            layer = std::max(layer, pAncestor->GetZLayer());
+            pRoot = pAncestor;
+        }
+
+        return RunKey(static_cast<uint8_t>(layer), pRoot->GetSequence(), pRoot != pControl, pControl->GetSequence());
+    }
+
+    int Window::GetTimeUntilNextTimer() const
+    {
+        // pending changes should be drawn and posted commands run straight away
+        if (m_dirty || !m_damage.empty() || m_commands.HasPending())
+            return 0;
+
+        int timeout = -1;
+        auto currentTime = GetTicks();
+        auto nextDue = [&timeout, currentTime](uint32_t timeRequested, uint32_t timeStarted)
+        {
+            auto timeElapsed = currentTime - timeStarted;
+            auto remaining = timeElapsed >= timeRequested ? 0 : static_cast<int>(timeRequested - timeElapsed);
+            if (timeout == -1 || remaining < timeout)
+                timeout = remaining;
+        };
+
+        for (auto& control : m_ctrlsElapsedTime)
+            nextDue(std::get<1>(control), std::get<2>(control));
+
+        for (auto& delayed : m_delayedResumes)
+            nextDue(std::get<1>(delayed), std::get<2>(delayed));
+
+        return timeout;
+    }
+
+    void Window::InvalidateRect(const SDL_Rect& rect)
+    {
+        // without a surface that keeps its content every present redraws the whole window.  the render
+        // thread can skip frames that are superseded so it always presents the whole window.
+        if (!m_options.SoftwareRenderer || m_options.RenderThread)
+        {
+            m_dirty = true;
+            return;
+        }
+
+        auto damage = SDLRectIntersection(rect, SDLRect(0, 0, m_dims.W, m_dims.H));
+        if (m_dirty || SDLRectEmpty(damage))
+            return;
+
+        // overlapping areas are merged so they aren't drawn twice
+        for (auto& existing : m_damage)
+        {
+            if (SDL_HasIntersection(&existing, &damage) == SDL_TRUE)
+            {
+                SDL_UnionRect(&existing, &damage, &existing);
+                return;
+            }
+        }
+
+        if (m_damage.size() == MaxDamageRects)
+            SDL_UnionRect(&m_damage.back(), &damage, &m_damage.back());
+        else
+            m_damage.push_back(damage);
+    }
+
+    bool Window::IsInModalScope(Control const* pControl) const
+    {
+        if (m_modals.empty())
+            return true;
+
+        for (auto pAncestor = pControl; pAncestor != nullptr; pAncestor = pAncestor->GetParent())
+        {
+            if (pAncestor == m_modals.back())
+                return true;
+        }
+
+        return false;
+    }
+
+    bool Window::IsLayer(Control* pControl) const
+    {
+        // a hidden layer isn't drawn so its descendants are rendered as usual
+        return m_layersSupported && detail::GetLayer(pControl) != nullptr && !pControl->GetHidden();
+    }
+
+    void Window::LoadImageAsync(const std::filesystem::path& fileName, const ImageLoadedCallback& callback)
+    {
+        RunInBackground([fileName]()
+            {
+                detail::TraceSpan span("Window::LoadImageAsync", "raster");
+
+                // converting to the texture's format is done here too
+                SDLSurface image(fileName);
+                auto pConverted = SDL_ConvertSurfaceFormat(image, SDL_PIXELFORMAT_ARGB8888, 0);
+                if (pConverted == nullptr)
+                    throw SDLException("SDL_ConvertSurfaceFormat failed with error '" + SDLGetError() + "'.");
+
+                return SDLSurface(pConverted);
+            },
+            [this, callback](SDLSurface&& surface)
+            {
+                auto texture = detail::CreateTextureForSurface(this, surface);
+                SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+                callback(std::move(texture));
+            });
+    }
+
+    void Window::ModalScopeChanged()
+    {
+        // the controls outside the scope are left out of the hit test when it's rebuilt
+        m_orderDirty = true;
+
+        if (m_pCapture != nullptr && !IsInModalScope(m_pCapture))
+            detail::SetPointerCapture(this, nullptr);
+
+        if (m_pCtrlUnderMouse != nullptr && !IsInModalScope(m_pCtrlUnderMouse))
+        {
+            detail::NotificationMouseExit(m_pCtrlUnderMouse);
+            m_pCtrlUnderMouse = nullptr;
+        }
+
+        if (m_pCtrlWithFocus != nullptr && !IsInModalScope(m_pCtrlWithFocus))
+        {
+            detail::NotificationFocusLost(m_pCtrlWithFocus);
+            m_pCtrlWithFocus = nullptr;
+        }
+    }
+
+    bool Window::MoveReordered()
+    {
+        // the runs of the descendants with a layer of their own depend on the layer and the root of
+        // their ancestors so they move as well
+        std::vector<Control*> heads;
+        std::unordered_set<Control const*> found;
+        std::vector<Control*> pending;
+        for (auto pReordered : m_reordered)
+        {
+            if (!found.insert(pReordered).second)
+                continue;
+
+            heads.push_back(pReordered);
+            pending.assign(pReordered->GetChildren().begin(), pReordered->GetChildren().end());
+            while (!pending.empty())
+            {
+                auto pControl = pending.back();
+                pending.pop_back();
+                if (detail::HasOwnZLayer(pControl) && found.insert(pControl).second)
+                    heads.push_back(pControl);
+
+                auto& children = pControl->GetChildren();
+                pending.insert(pending.end(), children.begin(), children.end());
+            }
+        }
+
+        // each run must still be together where it was.  a run inside another one is already in
+        // its place in it and moves with it.
+        struct MovedRun
+        {
+            Control* pHead;
+            size_t Length;
+            size_t Depth;
+            size_t Sibling;
+        };
+
+        std::vector<MovedRun> runs;
+        std::unordered_set<Control const*> unplaced;
+        std::unordered_set<Control const*> nested;
+        std::vector<Control*> run;
+        for (auto pHead : heads)
+        {
+            auto iter = m_controlIndices.find(pHead);
+            if (iter == m_controlIndices.end())
+                return false;
+
+            run.clear();
+            AppendRun(pHead, run);
+            auto first = m_controls.begin() + iter->second;
+            if (iter->second + run.size() > m_controls.size() || !std::equal(run.begin(), run.end(), first))
+                return false;
+
+            unplaced.insert(run.begin(), run.end());
+            nested.insert(run.begin() + 1, run.end());
+
+            // parents are placed before their children and older siblings before younger ones
+            size_t depth = 0;
+            for (auto pAncestor = pHead->GetParent(); pAncestor != nullptr; pAncestor = pAncestor->GetParent())
+                ++depth;
+
+            size_t sibling = 0;
+            if (pHead->GetParent() != nullptr)
+            {
+                auto& siblings = pHead->GetParent()->GetChildren();
+                sibling = static_cast<size_t>(std::find(siblings.begin(), siblings.end(), pHead) - siblings.begin());
+            }
+
+            runs.push_back({ pHead, run.size(), depth, sibling });
+        }
+
+        // the keys of the runs that moved are out of date, and a control that joined another run isn't a run any more
+        for (auto pHead : heads)
+        {
+            auto iter = m_runKeys.find(pHead);
+            if (iter != m_runKeys.end())
+            {
+                m_runs.erase(iter->second);
+                m_runKeys.erase(iter);
+            }
+        }
+
+        runs.erase(std::remove_if(runs.begin(), runs.end(), [&nested](const MovedRun& moved) { return nested.count(moved.pHead) != 0; }), runs.end());
+        std::sort(runs.begin(), runs.end(), [](const MovedRun& lhs, const MovedRun& rhs)
+            {
+                return std::tie(lhs.Depth, lhs.Sibling) < std::tie(rhs.Depth, rhs.Sibling);
+            });
+
+        for (auto& moved : runs)
+        {
+            auto first = m_controlIndices[moved.pHead];
+            auto last = first + moved.Length;
+            size_t place = 0;
+            if (moved.pHead->GetParent() == nullptr || detail::HasOwnZLayer(moved.pHead))
+            {
+                // before the first run in place that's ordered after it, the runs that aren't in place are ignored
+                auto key = GetRunKey(moved.pHead);
+                auto next = m_runs.upper_bound(key);
+                place = next != m_runs.end() ? m_controlIndices[next->second] : m_controls.size();
+                m_runs.emplace(key, moved.pHead);
+                m_runKeys.emplace(moved.pHead, key);
+            }
+            else
+            {
+                // right after the parent, or after the older sibling and those of its descendants that are in place
+                auto pParent = moved.pHead->GetParent();
+                auto pPrevious = pParent;
+                for (auto pSibling : pParent->GetChildren())
+                {
+                    if (pSibling == moved.pHead)
+                        break;
+
+                    if (!detail::HasOwnZLayer(pSibling))
+                        pPrevious = pSibling;
+                }
+
+                place = m_controlIndices[pPrevious] + 1;
+                for (auto i = place; pPrevious != pParent && i < m_controls.size(); ++i)
+                {
+                    if (unplaced.count(m_controls[i]) != 0)
+                        continue;
+
+                    auto pControl = m_controls[i];
+                    while (pControl != pPrevious && pControl->GetParent() != nullptr && !detail::HasOwnZLayer(pControl))
+                        pControl = pControl->GetParent();
+
+                    if (pControl != pPrevious)
+                        break;
+
+                    place = i + 1;
+                }
+            }
+
+            // only the controls between the old and the new place change their index
+            assert(place <= first || place >= last);
+            auto begin = m_controls.begin();
+            if (place < first)
+            {
+                std::rotate(begin + place, begin + first, begin + last);
+                RenumberControls(place, last);
+                first = place;
+            }
+            else if (place > last)
+            {
+                std::rotate(begin + first, begin + last, begin + place);
+                RenumberControls(first, place);
+                first = place - moved.Length;
+            }
+
+            for (auto i = first; i < first + moved.Length; ++i)
+                unplaced.erase(m_controls[i]);
+        }
+
+        return true;
+    }
+
+    void Window::NotifyActivity()
+    {
+        m_lastActivity = SDL_GetPerformanceCounter();
+    }
+
+    void Window::PaceFrame()
+    {
+        if (m_options.Pacing == FramePacing::Unlimited)
+            return;
+
+        auto frequency = SDL_GetPerformanceFrequency();
+        auto now = SDL_GetPerformanceCounter();
+
+        bool idle = m_options.Pacing == FramePacing::Adaptive &&
+            (now - m_lastActivity) > (m_options.IdleTimeout * frequency) / 1000;
+
+        auto frameRate = idle ? m_options.IdleFrameRate : m_options.TargetFrameRate;
+        if (frameRate == 0)
+            return;
+
+        // schedule from the previous deadline so the rate doesn't drift.  if the
+        // deadline has already passed don't try to catch up with a burst of frames.
+        m_nextFrame += frequency / frameRate;
+        if (m_nextFrame < now)
+            m_nextFrame = now;
+
+        detail::TraceSpan span("Window::PaceFrame", "frame");
+
+        while (now < m_nextFrame)
+        {
+            // sleep rather than spin so a paced window only uses the CPU for its frames.  SDL raises
+            // the system timer's resolution to a millisecond so a frame is at most about that late.
+            auto remaining = static_cast<int>(((m_nextFrame - now) * 1000 + frequency - 1) / frequency);
+
+            // while idle the wait can be long so wake as soon as an event arrives
+            if (idle)
+            {
+                if (SDL_WaitEventTimeout(nullptr, remaining) == 1)
+                {
+                    m_nextFrame = SDL_GetPerformanceCounter();
+                    break;
+                }
+            }
+            else
+            {
+                SDL_Delay(static_cast<uint32_t>(remaining));
+            }
+
+            now = SDL_GetPerformanceCounter();
+        }
+    }
+
+    void Window::PostCommand(const detail::CommandQueue::Key& key, std::function<void()> command)
+    {
+        if (key.first != nullptr)
+            m_commands.Post(key, std::move(command));
+        else
+            m_commands.Post(std::move(command));
+
+        // one event wakes the loop for all of the commands posted before the next drain
+        if (!m_commandEventPosted.exchange(true))
+        {
+            SDL_Event wakeEvent = {};
+            wakeEvent.type = s_commandEventType;
+            wakeEvent.user.windowID = m_windowId;
+            SDL_PushEvent(&wakeEvent);
+        }
+    }
+
     void Window::RemoveAllControls()
     {
+        // the updates posted for the controls would otherwise run after they're destroyed
+        m_commands.CancelAll();
         m_controls.clear();
         m_ctrlsElapsedTime.clear();
+        m_pCtrlWithFocus = nullptr;
+        m_pCtrlUnderMouse = nullptr;
+        detail::SetPointerCapture(this, nullptr);
+        m_modals.clear();
+        m_reordered.clear();
+        m_orderDirty = true;
+        Invalidate();
     }
 
-    void Window::Render()
+    RenderStatus Window::Render()
     {
-        // notify any controls for elapsed time
-        for (auto& control : m_ctrlsElapsedTime)
+        detail::TraceSpan span("Window::Render", "frame");
+        auto frameStart = SDL_GetPerformanceCounter();
+
+        if (m_recorder != nullptr)
+            m_recorder->RecordFrame(GetTicks());
+
+        // textures released by controls are reused once the frames that could draw them are presented,
+        // which is also when the render thread measures them
+        if (m_renderThread != nullptr)
+        {
+            m_texturePool.Reclaim(m_renderThread->GetPresentedFrame());
+            m_renderThread->TakeMeasurements(m_frameTimes, m_inputLatency);
+        }
+
+        // run the commands posted by other threads, those that don't fit in the budget wait for the
+        // next frame.  commands posted while draining push another event to wake the loop.
+        m_commandEventPosted = false;
+        if (m_commands.HasPending())
+        {
+            detail::TraceSpan commandSpan("Window::DrainCommands", "frame");
+            NotifyActivity();
+            m_commands.Drain(SDL_GetPerformanceFrequency() * m_options.CommandBudget / 1000000);
+        }
+
+        // notify any controls for elapsed time.  controls can register and unregister
+        // from their notification so index the entries and remove them afterwards.
+        m_notifyingTimers = true;
+        for (size_t i = 0; i < m_ctrlsElapsedTime.size(); ++i)
         {
-            auto timeRequested = std::get<1>(control);
-            auto timeElapsed = std::get<2>(control);
-            auto currentTime = SDL_GetTicks();
-            if (currentTime - timeElapsed >= timeRequested)
+            auto pControl = std::get<0>(m_ctrlsElapsedTime[i]);
+            auto timeRequested = std::get<1>(m_ctrlsElapsedTime[i]);
+            auto timeElapsed = std::get<2>(m_ctrlsElapsedTime[i]);
+            auto currentTime = GetTicks();
+            if (pControl != nullptr && currentTime - timeElapsed >= timeRequested)
             {
-                std::get<2>(control) = currentTime;
-                detail::NotificationElapsedTime(std::get<0>(control));
+                std::get<2>(m_ctrlsElapsedTime[i]) = currentTime;
+
+                // timers that fire faster than the idle frame rate are animating
+                if (timeRequested * m_options.IdleFrameRate < 1000)
+                    NotifyActivity();
+
+                detail::TraceSpan timerSpan(typeid(*pControl).name(), "timer");
+                detail::NotificationElapsedTime(pControl);
             }
         }
 
-        // only render if the window is visible
-        if (ShouldRender())
+        m_notifyingTimers = false;
+        m_ctrlsElapsedTime.erase(std::remove_if(m_ctrlsElapsedTime.begin(), m_ctrlsElapsedTime.end(), [](const ControlElapsedTime& entry)
+            {
+                return std::get<0>(entry) == nullptr;
+            }), m_ctrlsElapsedTime.end());
+
+        // resume the coroutines whose delay has elapsed, they're taken out first as they can start another
+        if (!m_delayedResumes.empty())
         {
-            SDL_RenderClear(m_renderer);
+            auto currentTime = GetTicks();
+            auto firstDue = std::stable_partition(m_delayedResumes.begin(), m_delayedResumes.end(), [currentTime](const DelayedResume& delayed)
+                {
+                    return currentTime - std::get<2>(delayed) < std::get<1>(delayed);
+                });
+
+            std::vector<DelayedResume> due(firstDue, m_delayedResumes.end());
+            m_delayedResumes.erase(firstDue, m_delayedResumes.end());
+            for (auto& delayed : due)
+            {
+                NotifyActivity();
+                std::get<0>(delayed).resume();
+            }
+        }
+
+        // coroutines report their exceptions instead of throwing them into whatever resumed them
+        if (s_taskError != nullptr)
+            std::rethrow_exception(std::exchange(s_taskError, nullptr));
+
+        // only render if the window is visible and its content has changed
+        auto status = RenderStatus::NotVisible;
+        if (ShouldRender() && !m_dirty && m_damage.empty())
+        {
+            // input that didn't change anything has nothing to wait for
+            m_pendingInputCounter = 0;
+            status = RenderStatus::NothingChanged;
+        }
+        else if (ShouldRender())
+        {
+            // controls invalidated while drawing are picked up by the next frame
+            bool fullFrame = m_dirty;
+            m_dirty = false;
+            m_frameDamage.swap(m_damage);
+            m_damage.clear();
+            status = RenderStatus::Presented;
+
+            EnsureOrdered();
+            UpdateRenderClips();
+
+            // there's no need to clear the background if it's completely covered
+            bool covered = CullOccludedControls();
+
+            // the controls' drawing is recorded then replayed here or by the render thread
+            ++m_frameNumber;
+            m_pDisplayList->Reset(m_frameNumber);
+
+            if (fullFrame)
+            {
+                if (!covered)
+                    m_pDisplayList->Clear(m_bColor);
+
+                RenderControls(nullptr, nullptr);
+            }
+            else
+            {
+                // the window's surface still holds the previous frame so only the damage is drawn
+                for (auto& damage : m_frameDamage)
+                {
+                    if (!covered)
+                        m_pDisplayList->FillRect(damage, m_bColor);
+
+                    RenderControls(nullptr, &damage);
+                }
+            }
+
+            if (m_renderThread != nullptr)
+            {
+                // the textures are updated before the frame draws them
+                if (!m_pUploads->IsEmpty())
+                {
+                    m_pUploads->Append(*m_pDisplayList);
+                    m_pUploads->Swap(*m_pDisplayList);
+                    m_pUploads->Reset(0);
+                }
+
+                // the frame is measured by the render thread when it's presented
+                m_pDisplayList->SetTiming({ frameStart, m_pendingInputCounter, m_pendingInputDelay });
+                m_pendingInputCounter = 0;
+                m_renderThread->Publish(*m_pDisplayList);
+                m_texturePool.SetFrame(m_frameNumber + 1);
+            }
+            else
+            {
+                std::lock_guard<std::mutex> lock(m_texturePool.GetRendererLock());
+                m_pDisplayList->Replay(m_renderer);
+
+                if (fullFrame)
+                {
+                    detail::TraceSpan presentSpan("SDL_RenderPresent", "frame");
+                    SDL_RenderPresent(m_renderer);
+                }
+                else
+                {
+                    detail::TraceSpan presentSpan("SDL_UpdateWindowSurfaceRects", "frame");
+                    SDL_RenderFlush(m_renderer);
+                    SDL_UpdateWindowSurfaceRects(m_window, m_frameDamage.data(), static_cast<int>(m_frameDamage.size()));
+                }
+
+                auto frameEnd = SDL_GetPerformanceCounter();
+                auto ticksPerMicrosecond = SDL_GetPerformanceFrequency() / 1000000.0;
+                m_frameTimes.Record(static_cast<uint64_t>((frameEnd - frameStart) / ticksPerMicrosecond));
+
+                // this present reflects all input translated before it
+                if (m_pendingInputCounter != 0)
+                {
+                    auto latency = static_cast<uint64_t>((frameEnd - m_pendingInputCounter) / ticksPerMicrosecond);
+                    m_inputLatency.Record(latency + m_pendingInputDelay * 1000ull);
+                    m_pendingInputCounter = 0;
+                }
+            }
+        }
+
+        // updates made while nothing is drawn are handed over anyway so they don't pile up
+        if (status != RenderStatus::Presented && m_renderThread != nullptr && !m_pUploads->IsEmpty())
+            m_renderThread->Publish(*m_pUploads);
+
+        PaceFrame();
+        return status;
+    }
+
+    void Window::RenderControl(Control* pControl)
+    {
+        auto& retained = detail::GetDisplayList(pControl);
+        if (detail::IsDrawingDirty(pControl))
+        {
+            // the control draws in window coordinates whatever target it's drawn into
+            detail::ClearDrawingDirty(pControl);
+            retained.Reset(0);
+
+            auto origin = m_drawOrigin;
+            m_drawOrigin = SDLPoint(0, 0);
+            m_pRecording = &retained;
 
-            for (auto const control : m_controls)
+            detail::Render(pControl);
+
+            m_pRecording = m_pDisplayList.get();
+            m_drawOrigin = origin;
+        }
+
+        m_pDisplayList->AppendRetained(retained, SDLPoint(-m_drawOrigin.x, -m_drawOrigin.y));
+    }
+
+    void Window::RenderControls(Control* pLayer, SDL_Rect const* pDamage)
+    {
+        // the clip rect only changes between controls in different containers.
+        // start with an empty clip so it's set for the first control.
+        auto currentClip = SDLRect(0, 0, 0, 0);
+
+        for (auto const control : m_controls)
+        {
+            auto clip = detail::GetRenderClip(control);
+            if (pDamage != nullptr)
+                clip = SDLRectIntersection(clip, *pDamage);
+
+            if (SDLRectEmpty(clip) || (control != pLayer && detail::GetRenderLayer(control) != pLayer))
+                continue;
+
+            // a layer is drawn in full into its own texture
+            bool isLayer = IsLayer(control);
+            if (control == pLayer)
+                clip = control->GetLocation();
+            else if (isLayer && UpdateLayer(control))
+                currentClip = SDLRect(0, 0, 0, 0);  // changing the render target resets the clip rect
+
+            clip = ToTarget(clip);
+            if (clip != currentClip)
             {
-                detail::Render(control);
+                SetClip(&clip);
+                currentClip = clip;
             }
 
-            SDL_RenderPresent(m_renderer);
+            if (isLayer && control != pLayer)
+                DrawTexture(control->GetLocation(), *detail::GetLayer(control), nullptr);
+            else
+                RenderControl(control);
         }
+
+        SetClip(nullptr);
+    }
+
+    void Window::RenderCopy(const SDLTexture& texture, SDL_Rect const* source, const SDL_Rect& destination)
+    {
+        // textures with room to grow only copy their content
+        auto content = SDLRect(0, 0, texture.GetWidth(), texture.GetHeight());
+        auto target = ToTarget(destination);
+        if (source == nullptr && (texture.GetWidth() < texture.GetCapacityWidth() || texture.GetHeight() < texture.GetCapacityHeight()))
+        {
+            source = &content;
+        }
+        else if (source != nullptr && (source->x + source->w > content.w || source->y + source->h > content.h))
+        {
+            // an explicit source past the content would show stale pixels from an earlier use of a
+            // pooled texture so copy only the content and shrink the destination to match
+            SDL_Rect clamped;
+            if (!SDL_IntersectRect(source, &content, &clamped))
+                return;
+
+            target.x += ((clamped.x - source->x) * target.w) / source->w;
+            target.y += ((clamped.y - source->y) * target.h) / source->h;
+            target.w = (clamped.w * target.w) / source->w;
+            target.h = (clamped.h * target.h) / source->h;
+            content = clamped;
+            source = &content;
+        }
+
+        m_pRecording->CopyTexture(texture, source, target);
+    }
+
+    void Window::RenumberControls(size_t first, size_t last)
+    {
+        for (auto i = first; i < last; ++i)
+        {
+            m_controlIndices[m_controls[i]] = i;
+            m_hitTest.Set(i, m_controls[i]->GetLocation(), m_controls[i]->GetHidden() || !IsInModalScope(m_controls[i]));
+        }
+    }
+
+    void Window::ResetFrameStatistics()
+    {
+        // the frames the render thread measured before now are dropped too
+        if (m_renderThread != nullptr)
+            m_renderThread->TakeMeasurements(m_frameTimes, m_inputLatency);
+
+        m_frameTimes.Reset();
+        m_inputLatency.Reset();
     }
 
     void Window::SetCursorHidden(bool hidden)
@@ -356,15 +1246,161 @@ namespace libsdlgui
         }
     }
 
+    void Window::SetClip(SDL_Rect const* clip)
+    {
+        m_clipEnabled = clip != nullptr;
+        if (clip != nullptr)
+            m_clip = *clip;
+
+        m_pDisplayList->SetClip(clip);
+    }
+
+    void Window::SetTarget(SDL_Texture* pTexture)
+    {
+        // changing the render target resets the clip rect
+        m_pTarget = pTexture;
+        m_clipEnabled = false;
+        m_pDisplayList->SetTarget(pTexture);
+    }
+
     bool Window::ShouldRender()
     {
         return ((m_flags & State::Minimized) != State::Minimized);
     }
 
+    void Window::StartRecording(const std::filesystem::path& fileName)
+    {
+        m_recorder = std::make_unique<detail::InputRecorder>(fileName, m_dims, GetTicks());
+    }
+
+    void Window::StopRecording()
+    {
+        m_recorder.reset();
+    }
+
+    SDL_Rect Window::ToTarget(const SDL_Rect& rect) const
+    {
+        // while a layer is drawn the origin is the layer's location
+        return SDLRect(rect.x - m_drawOrigin.x, rect.y - m_drawOrigin.y, rect.w, rect.h);
+    }
+
+    void Window::TrackInputEvent(const SDL_Event& sdlEvent)
+    {
+        // only the oldest event waiting for a present is tracked, events
+        // that arrive later are reflected by the same present.
+        if (m_pendingInputCounter != 0)
+            return;
+
+        // the event's timestamp has millisecond resolution so capture the time it
+        // spent in the queue then time the rest with the performance counter.
+        m_pendingInputCounter = SDL_GetPerformanceCounter();
+        auto now = SDL_GetTicks();
+        m_pendingInputDelay = now >= sdlEvent.common.timestamp ? now - sdlEvent.common.timestamp : 0;
+    }
+
+    Control* Window::UpdateControlUnderMouse(const SDL_Point& point)
+    {
+        auto index = m_hitTest.FindTopmost(point);
+        auto pControl = index > -1 ? m_controls[index] : nullptr;
+
+        // notify the previous control the mouse has left it.  controls that don't handle
+        // input still take the mouse from the controls beneath them, they just aren't notified.
+        if (m_pCtrlUnderMouse != nullptr && m_pCtrlUnderMouse != pControl)
+            detail::NotificationMouseExit(m_pCtrlUnderMouse);
+
+        // if this control is already under the mouse don't notify it again
+        if (m_pCtrlUnderMouse != pControl)
+        {
+            m_pCtrlUnderMouse = pControl;
+            if (pControl != nullptr && pControl->HasEventInterest(Control::EventInterest::Hover))
+                detail::NotificationMouseEnter(pControl);
+        }
+
+        return pControl;
+    }
+
+    bool Window::UpdateLayer(Control* pLayer)
+    {
+        auto pTexture = detail::GetLayer(pLayer);
+        auto location = pLayer->GetLocation();
+
+        if (pTexture->GetWidth() != location.w || pTexture->GetHeight() != location.h)
+        {
+            // resizing within the layer's size class keeps its texture
+            if (*pTexture != nullptr && detail::TexturePool::GetSizeClass(location.w) == pTexture->GetCapacityWidth() &&
+                detail::TexturePool::GetSizeClass(location.h) == pTexture->GetCapacityHeight())
+                pTexture->SetSize(location.w, location.h);
+            else
+                *pTexture = m_texturePool.Acquire(SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, location.w, location.h);
+        }
+        else if (!detail::IsLayerDirty(pLayer))
+        {
+            return false;
+        }
+
+        detail::TraceSpan span(typeid(*pLayer).name(), "layer");
+
+        {
+            // layers can be nested so the holder restores the previous target when done
+            detail::RenderTargetHolder targetHolder(this, *pTexture, SDLPoint(location.x, location.y));
+
+            m_pDisplayList->Clear(pLayer->GetBackgroundColor());
+
+            RenderControls(pLayer, nullptr);
+        }
+
+        detail::ClearLayerDirty(pLayer);
+        return true;
+    }
+
+    void Window::UpdateRenderClips()
+    {
+        detail::TraceSpan span("Window::UpdateRenderClips", "frame");
+
+        // controls that aren't reached from a root are culled
+        for (auto control : m_controls)
+            detail::SetRenderClip(control, SDLRect(0, 0, 0, 0));
+
+        auto windowBounds = SDLRect(0, 0, m_dims.W, m_dims.H);
+        for (auto control : m_controls)
+        {
+            if (control->GetParent() == nullptr)
+                ComputeRenderClips(control, windowBounds, nullptr);
+        }
+    }
+
     bool Window::TranslateEvent(const SDL_Event& sdlEvent)
     {
+        detail::TraceSpan span("Window::TranslateEvent", "input");
         bool quit = false;
 
+        // with more than one window each only handles its own events
+        auto windowId = detail::GetEventWindowId(sdlEvent);
+        if (windowId != 0 && windowId != m_windowId)
+            return quit;
+
+        // posted commands only wake the loop, they're run by Render()
+        if (sdlEvent.type == s_commandEventType)
+            return quit;
+
+        if (m_recorder != nullptr)
+            m_recorder->RecordEvent(sdlEvent, GetTicks());
+
+        switch (sdlEvent.type)
+        {
+        case SDL_KEYDOWN:
+        case SDL_KEYUP:
+        case SDL_MOUSEBUTTONDOWN:
+        case SDL_MOUSEBUTTONUP:
+        case SDL_MOUSEWHEEL:
+        case SDL_MOUSEMOTION:
+        case SDL_TEXTINPUT:
+            TrackInputEvent(sdlEvent);
+            break;
+        }
+
+        NotifyActivity();
+
         switch (sdlEvent.type)
         {
         case SDL_KEYDOWN:
@@ -393,12 +1429,44 @@ namespace libsdlgui
             case SDL_WINDOWEVENT_MAXIMIZED:
             case SDL_WINDOWEVENT_RESTORED:
                 m_flags ^= State::Minimized;
+                Invalidate();
+                break;
+            case SDL_WINDOWEVENT_EXPOSED:
+            case SDL_WINDOWEVENT_SHOWN:
+                Invalidate();
                 break;
             case SDL_WINDOWEVENT_SIZE_CHANGED:
                 OnWindowResized(sdlEvent.window);
                 break;
             }
             break;
+        case SDL_RENDER_TARGETS_RESET:
+        case SDL_RENDER_DEVICE_RESET:
+            // the content of the layers and of controls' own render targets was lost.  a reset
+            // device also loses the textures that the controls' retained drawing refers to.
+            for (auto control : m_controls)
+            {
+                if (control->GetCacheAsLayer() || sdlEvent.type == SDL_RENDER_DEVICE_RESET)
+                    control->Invalidate();
+
+                detail::NotificationRenderTargetsReset(control);
+            }
+
+            // pooled textures would be handed out without content.  the frames and texture updates
+            // the render thread hasn't replayed refer to the retired textures destroyed with them.
+            if (sdlEvent.type == SDL_RENDER_DEVICE_RESET)
+            {
+                if (m_renderThread != nullptr)
+                {
+                    m_renderThread->Discard();
+                    m_pUploads->Reset(0);
+                }
+
+                m_texturePool.Clear();
+            }
+
+            Invalidate();
+            break;
         case SDL_QUIT:
             quit = true;
             break;
@@ -409,16 +1477,38 @@ namespace libsdlgui
 
     namespace detail
     {
+        SDLTexture AcquireRenderTarget(Window* pWindow, int width, int height)
+        {
+            assert(pWindow->m_layersSupported);
+            return pWindow->m_texturePool.Acquire(SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, width, height);
+        }
+
         void AddControl(Window* pWindow, Control* pControl)
         {
             assert(std::find(pWindow->m_controls.begin(), pWindow->m_controls.end(), pControl) == pWindow->m_controls.end());
             pWindow->m_controls.push_back(pControl);
 
-            // sort the controls in ascending z-order
-            std::sort(pWindow->m_controls.begin(), pWindow->m_controls.end(), [](Control* lhs, Control* rhs)
-                {
-                    return detail::GetZOrder(lhs) < detail::GetZOrder(rhs);
-                });
+            // the controls are put in draw order before they're next used
+            pWindow->m_orderDirty = true;
+            pWindow->Invalidate();
+        }
+
+        void ControlGeometryChanged(Window* pWindow, Control* pControl)
+        {
+            // if the order is dirty the geometry will be rebuilt before it's next used
+            if (pWindow->m_orderDirty)
+                return;
+
+            auto iter = pWindow->m_controlIndices.find(pControl);
+            assert(iter != pWindow->m_controlIndices.end());
+            pWindow->m_hitTest.Set(iter->second, pControl->GetLocation(), pControl->GetHidden() || !pWindow->IsInModalScope(pControl));
+        }
+
+        void ControlOrderChanged(Window* pWindow, Control* pControl)
+        {
+            // the control is moved before it's next used, unless all of the controls are ordered anyway
+            if (!pWindow->m_orderDirty)
+                pWindow->m_reordered.push_back(pControl);
         }
 
         SDL_Color GetBackgroundColor(Window const* pWindow)
@@ -431,11 +1521,36 @@ namespace libsdlgui
             return pWindow->m_pFont;
         }
 
+        GlyphAtlas* GetGlyphAtlas(Window* pWindow, Font const* font, const SDL_Color& fgColor, const SDL_Color& bgColor)
+        {
+            auto& atlas = pWindow->m_glyphAtlases[Window::GlyphAtlasKey(font, PackColor(fgColor), PackColor(bgColor))];
+            if (atlas == nullptr)
+                atlas = std::make_unique<GlyphAtlas>(pWindow, font, fgColor, bgColor);
+
+            return atlas.get();
+        }
+
         SDL_Color GetForegroundColor(Window const* pWindow)
         {
             return pWindow->m_fColor;
         }
 
+        Control* GetPointerCapture(Window const* pWindow)
+        {
+            return pWindow->m_pCapture;
+        }
+
+        void PushModal(Window* pWindow, Control* pControl)
+        {
+            // a control that's already modal keeps its place so showing it again doesn't reorder the stack
+            auto& modals = pWindow->m_modals;
+            if (std::find(modals.begin(), modals.end(), pControl) != modals.end())
+                return;
+
+            modals.push_back(pControl);
+            pWindow->ModalScopeChanged();
+        }
+
         void RegisterForElapsedTimeNotification(Window* pWindow, Control* pControl, uint32_t ticks)
         {
             // check if the control is already registered, if
@@ -450,13 +1565,13 @@ namespace libsdlgui
 
             if (iter == pWindow->m_ctrlsElapsedTime.end())
             {
-                pWindow->m_ctrlsElapsedTime.push_back(Window::ControlElapsedTime(pControl, ticks, SDL_GetTicks()));
+                pWindow->m_ctrlsElapsedTime.push_back(Window::ControlElapsedTime(pControl, ticks, pWindow->GetTicks()));
             }
             else
             {
                 // update the value and start time
                 std::get<1>(*iter) = ticks;
-                std::get<2>(*iter) = SDL_GetTicks();
+                std::get<2>(*iter) = pWindow->GetTicks();
             }
         }
 
@@ -467,22 +1582,127 @@ namespace libsdlgui
             if (controlIter != pWindow->m_controls.end())
             {
                 detail::UnregisterForElapsedTimeNotification(pWindow, *controlIter);
+                pWindow->m_commands.Cancel(pControl);
                 pWindow->m_controls.erase(controlIter);
+                pWindow->m_orderDirty = true;
+                pWindow->Invalidate();
+
+                // don't leave dangling pointers to the control
+                if (pWindow->m_pCtrlWithFocus == pControl)
+                    pWindow->m_pCtrlWithFocus = nullptr;
+                if (pWindow->m_pCtrlUnderMouse == pControl)
+                    pWindow->m_pCtrlUnderMouse = nullptr;
+                if (pWindow->m_pCapture == pControl)
+                    SetPointerCapture(pWindow, nullptr);
+
+                RemoveModal(pWindow, pControl);
             }
         }
 
+        void RemoveModal(Window* pWindow, Control* pControl)
+        {
+            auto iter = std::find(pWindow->m_modals.begin(), pWindow->m_modals.end(), pControl);
+            if (iter == pWindow->m_modals.end())
+                return;
+
+            bool wasTopmost = pControl == pWindow->m_modals.back();
+            pWindow->m_modals.erase(iter);
+            if (wasTopmost)
+                pWindow->ModalScopeChanged();
+        }
+
+        bool RenderTargetsSupported(Window const* pWindow)
+        {
+            return pWindow->m_layersSupported;
+        }
+
+        RenderTargetHolder::RenderTargetHolder(Window* pWindow, const SDLTexture& target, const SDL_Point& origin) :
+            m_pWindow(pWindow), m_pPrevRecording(pWindow->m_pRecording), m_pPrevTarget(pWindow->m_pTarget),
+            m_prevOrigin(pWindow->m_drawOrigin), m_prevClip(pWindow->m_clip), m_prevClipEnabled(pWindow->m_clipEnabled)
+        {
+            m_pWindow->m_pRecording = m_pWindow->m_pDisplayList.get();
+            m_pWindow->SetTarget(target);
+            m_pWindow->m_drawOrigin = origin;
+        }
+
+        RenderTargetHolder::~RenderTargetHolder()
+        {
+            m_pWindow->SetTarget(m_pPrevTarget);
+            m_pWindow->m_drawOrigin = m_prevOrigin;
+            m_pWindow->m_pRecording = m_pPrevRecording;
+
+            // changing the render target resets the clip rect
+            if (m_prevClipEnabled)
+                m_pWindow->SetClip(&m_prevClip);
+        }
+
+        void ReportTaskError(std::exception_ptr error)
+        {
+            if (Window::s_taskError == nullptr)
+                Window::s_taskError = error;
+        }
+
+        void ResumeAfter(Window* pWindow, uint32_t ticks, std::coroutine_handle<> handle)
+        {
+            pWindow->m_delayedResumes.push_back(Window::DelayedResume(handle, ticks, pWindow->GetTicks()));
+        }
+
+        void ResumeTask(Window* pWindow, std::coroutine_handle<> handle)
+        {
+            auto& suspended = pWindow->m_suspendedTasks;
+            suspended.erase(std::find(suspended.begin(), suspended.end(), handle));
+            handle.resume();
+        }
+
+        void SetPointerCapture(Window* pWindow, Control* pControl)
+        {
+            // SDL keeps reporting the mouse while it's outside the window so a drag isn't lost
+            if (pControl != nullptr && pWindow->m_pCapture == nullptr)
+                SDL_CaptureMouse(SDL_TRUE);
+            else if (pControl == nullptr && pWindow->m_pCapture != nullptr)
+                SDL_CaptureMouse(SDL_FALSE);
+
+            pWindow->m_pCapture = pControl;
+        }
+
+        void SuspendTask(Window* pWindow, std::coroutine_handle<> handle)
+        {
+            pWindow->m_suspendedTasks.push_back(handle);
+        }
+
         void UnregisterForElapsedTimeNotification(Window* pWindow, Control* pControl)
         {
             for (auto iter = pWindow->m_ctrlsElapsedTime.begin(); iter != pWindow->m_ctrlsElapsedTime.end(); ++iter)
             {
                 if (std::get<0>(*iter) == pControl)
                 {
-                    pWindow->m_ctrlsElapsedTime.erase(iter);
+                    // the entries are being walked so only mark it for removal
+                    if (pWindow->m_notifyingTimers)
+                        std::get<0>(*iter) = nullptr;
+                    else
+                        pWindow->m_ctrlsElapsedTime.erase(iter);
+
                     break;
                 }
             }
         }
 
+        void UpdateTexture(Window const* pWindow, SDL_Texture* pTexture, const SDL_Rect& area, const void* pixels, int pitch)
+        {
+            // the update is recorded with the window's next frame, taking the frame number it follows
+            if (pWindow->m_renderThread != nullptr)
+            {
+                if (pWindow->m_pUploads->IsEmpty())
+                    pWindow->m_pUploads->Reset(pWindow->m_frameNumber);
+
+                pWindow->m_pUploads->UpdateTexture(pTexture, area, pixels, pitch);
+                return;
+            }
+
+            if (SDL_UpdateTexture(pTexture, &area, pixels, pitch) != 0)
+                throw SDLException("SDL_UpdateTexture failed with error '" + SDLGetError() + "'.");
+        }
+
     } // namespace detail
 
 } // namespace libsdlgui
@@ -7,6 +7,9 @@ namespace libsdlgui
     CheckBox::CheckBox(Window* pWindow, const SDL_Rect& location) :
         Control(pWindow, location), m_text(pWindow, location), m_checked(false)
     {
+        // the check box only responds to clicks
+        SetEventInterest(EventInterest::None);
+
         // move the text to the right of the check box and set some default properties
         m_text.SetLocation(SDLRect(location.x + 32, location.y, location.w, location.h));
         m_text.SetAlignment(TextAlignment::MiddleLeft);
@@ -16,6 +19,7 @@ namespace libsdlgui
     void CheckBox::OnLeftClick(const SDL_Point&)
     {
         m_checked = !m_checked;
+        Invalidate();
         if (m_callback)
             m_callback(m_checked);
     }
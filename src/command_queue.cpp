@@ -0,0 +1,161 @@
+#include "stdafx.h"
+#include "command_queue.hpp"
+
+namespace libsdlgui::detail
+{
+    CommandQueue::CommandQueue() : m_head(&m_stub), m_tail(&m_stub)
+    {
+        // empty
+    }
+
+    CommandQueue::~CommandQueue()
+    {
+        Collect();
+        for (auto pNode : m_pending)
+            delete pNode;
+
+        // a node might be stranded behind a post that was interrupted
+        while (auto pNode = Pop())
+            delete pNode;
+    }
+
+    void CommandQueue::Cancel(Control const* pControl)
+    {
+        Collect();
+        for (auto pNode : m_pending)
+        {
+            if (pNode->CoalesceKey.first == pControl && pNode->Action != nullptr)
+            {
+                pNode->Action = nullptr;
+                m_latest.erase(pNode->CoalesceKey);
+            }
+        }
+    }
+
+    void CommandQueue::CancelAll()
+    {
+        Collect();
+        for (auto pNode : m_pending)
+        {
+            if (pNode->CoalesceKey.first != nullptr)
+                pNode->Action = nullptr;
+        }
+
+        m_latest.clear();
+    }
+
+    void CommandQueue::Collect()
+    {
+        while (auto pNode = Pop())
+        {
+            if (pNode->CoalesceKey.first != nullptr)
+            {
+                // the older update is left in place as an empty command so the order is kept
+                auto& pLatest = m_latest[pNode->CoalesceKey];
+                if (pLatest != nullptr)
+                    pLatest->Action = nullptr;
+
+                pLatest = pNode;
+            }
+
+            m_pending.push_back(pNode);
+        }
+    }
+
+    bool CommandQueue::Drain(uint64_t budget)
+    {
+        Collect();
+
+        auto start = SDL_GetPerformanceCounter();
+        bool ran = false;
+        while (!m_pending.empty())
+        {
+            if (ran && SDL_GetPerformanceCounter() - start >= budget)
+                break;
+
+            // the node is freed even if its command throws
+            std::unique_ptr<Node> pNode(m_pending.front());
+            m_pending.pop_front();
+            if (pNode->Action == nullptr)
+                continue;
+
+            if (pNode->CoalesceKey.first != nullptr)
+                m_latest.erase(pNode->CoalesceKey);
+
+            auto action = std::move(pNode->Action);
+            ran = true;
+            action();
+        }
+
+        return HasPending();
+    }
+
+    bool CommandQueue::HasPending() const
+    {
+        return !m_pending.empty() || m_tail != &m_stub || m_stub.Next.load(std::memory_order_acquire) != nullptr ||
+            m_head.load(std::memory_order_acquire) != &m_stub;
+    }
+
+    CommandQueue::Node* CommandQueue::Pop()
+    {
+        auto pTail = m_tail;
+        auto pNext = pTail->Next.load(std::memory_order_acquire);
+
+        // step over the stub, it's pushed back whenever the queue is about to become empty
+        if (pTail == &m_stub)
+        {
+            if (pNext == nullptr)
+                return nullptr;
+
+            m_tail = pNext;
+            pTail = pNext;
+            pNext = pNext->Next.load(std::memory_order_acquire);
+        }
+
+        if (pNext != nullptr)
+        {
+            m_tail = pNext;
+            return pTail;
+        }
+
+        // a producer has exchanged the head but hasn't linked its node yet
+        if (pTail != m_head.load(std::memory_order_acquire))
+            return nullptr;
+
+        Push(&m_stub);
+
+        pNext = pTail->Next.load(std::memory_order_acquire);
+        if (pNext != nullptr)
+        {
+            m_tail = pNext;
+            return pTail;
+        }
+
+        return nullptr;
+    }
+
+    void CommandQueue::Post(Command command)
+    {
+        auto pNode = new Node();
+        pNode->Action = std::move(command);
+        Push(pNode);
+    }
+
+    void CommandQueue::Post(const Key& key, Command command)
+    {
+        assert(key.first != nullptr);
+
+        auto pNode = new Node();
+        pNode->Action = std::move(command);
+        pNode->CoalesceKey = key;
+        Push(pNode);
+    }
+
+    void CommandQueue::Push(Node* pNode)
+    {
+        pNode->Next.store(nullptr, std::memory_order_relaxed);
+        auto pPrev = m_head.exchange(pNode, std::memory_order_acq_rel);
+        pPrev->Next.store(pNode, std::memory_order_release);
+    }
+
+} // namespace libsdlgui::detail
@@ -0,0 +1,243 @@
+#include "stdafx.h"
+#include "display_list.hpp"
+#include "sdl_helpers.hpp"
+
+namespace libsdlgui::detail
+{
+    DisplayList::Command& DisplayList::Add(Operation op)
+    {
+        auto& command = m_commands.emplace_back();
+        command.Op = op;
+        command.HasSource = false;
+        command.pTexture = nullptr;
+        return command;
+    }
+
+    void DisplayList::Append(const DisplayList& later)
+    {
+        auto first = m_commands.insert(m_commands.end(), later.m_commands.begin(), later.m_commands.end());
+        m_frame = later.m_frame;
+        if (later.m_timing.Start != 0)
+            m_timing.Start = later.m_timing.Start;
+
+        if (m_timing.InputCounter == 0)
+        {
+            m_timing.InputCounter = later.m_timing.InputCounter;
+            m_timing.InputDelay = later.m_timing.InputDelay;
+        }
+
+        // the later list's updates refer to its pixels, which now follow ours
+        if (!later.m_pixels.empty())
+        {
+            auto offset = m_pixels.size();
+            m_pixels.insert(m_pixels.end(), later.m_pixels.begin(), later.m_pixels.end());
+            for (auto iter = first; iter != m_commands.end(); ++iter)
+            {
+                if (iter->Op == Operation::UpdateTexture)
+                    iter->Pixels += offset;
+            }
+        }
+    }
+
+    void DisplayList::AppendRetained(const DisplayList& retained, const SDL_Point& offset)
+    {
+        auto first = m_commands.insert(m_commands.end(), retained.m_commands.begin(), retained.m_commands.end());
+        if (offset.x == 0 && offset.y == 0)
+            return;
+
+        for (auto iter = first; iter != m_commands.end(); ++iter)
+        {
+            iter->Rect.x += offset.x;
+            iter->Rect.y += offset.y;
+
+            // both of a line's end points move
+            if (iter->Op == Operation::DrawLine)
+            {
+                iter->Rect.w += offset.x;
+                iter->Rect.h += offset.y;
+            }
+        }
+    }
+
+    std::vector<DisplayList::Command>::const_iterator DisplayList::Batch(std::vector<Command>::const_iterator first) const
+    {
+        m_batch.clear();
+
+        auto iter = first;
+        for (; iter != m_commands.end() && iter->Op == first->Op && iter->Color == first->Color; ++iter)
+            m_batch.push_back(iter->Rect);
+
+        return iter;
+    }
+
+    void DisplayList::Clear(const SDL_Color& color)
+    {
+        Add(Operation::Clear).Color = color;
+    }
+
+    void DisplayList::CopyTexture(SDL_Texture* pTexture, SDL_Rect const* source, const SDL_Rect& destination)
+    {
+        auto& command = Add(Operation::CopyTexture);
+        command.pTexture = pTexture;
+        command.Rect = destination;
+        if (source != nullptr)
+        {
+            command.HasSource = true;
+            command.Source = *source;
+        }
+    }
+
+    void DisplayList::DrawLine(const SDL_Point& p1, const SDL_Point& p2, const SDL_Color& color)
+    {
+        auto& command = Add(Operation::DrawLine);
+        command.Rect = SDLRect(p1.x, p1.y, p2.x, p2.y);
+        command.Color = color;
+    }
+
+    void DisplayList::DrawRect(const SDL_Rect& rect, const SDL_Color& color)
+    {
+        auto& command = Add(Operation::DrawRect);
+        command.Rect = rect;
+        command.Color = color;
+    }
+
+    bool DisplayList::DrawsWindow() const
+    {
+        SDL_Texture* pTarget = nullptr;
+        for (auto& command : m_commands)
+        {
+            if (command.Op == Operation::SetTarget)
+                pTarget = command.pTexture;
+            else if (command.Op != Operation::UpdateTexture && pTarget == nullptr)
+                return true;
+        }
+
+        return false;
+    }
+
+    void DisplayList::DropWindowDrawing()
+    {
+        // the pixels of the updates that are kept are left where they are
+        SDL_Texture* pTarget = nullptr;
+        m_commands.erase(std::remove_if(m_commands.begin(), m_commands.end(), [&pTarget](const Command& command)
+            {
+                if (command.Op == Operation::UpdateTexture)
+                    return false;
+
+                if (command.Op != Operation::SetTarget)
+                    return pTarget == nullptr;
+
+                pTarget = command.pTexture;
+                return false;
+            }), m_commands.end());
+    }
+
+    void DisplayList::FillRect(const SDL_Rect& rect, const SDL_Color& color)
+    {
+        auto& command = Add(Operation::FillRect);
+        command.Rect = rect;
+        command.Color = color;
+    }
+
+    void DisplayList::Replay(SDL_Renderer* pRenderer) const
+    {
+        // the draw color is only set when it changes
+        auto color = SDLColor(0, 0, 0, 0);
+        bool colorSet = false;
+        auto setColor = [&](const SDL_Color& newColor)
+        {
+            if (!colorSet || newColor != color)
+            {
+                SDL_SetRenderDrawColor(pRenderer, newColor.r, newColor.g, newColor.b, newColor.a);
+                color = newColor;
+                colorSet = true;
+            }
+        };
+
+        for (auto iter = m_commands.begin(); iter != m_commands.end();)
+        {
+            auto& command = *iter++;
+            switch (command.Op)
+            {
+            case Operation::Clear:
+                setColor(command.Color);
+                SDL_RenderClear(pRenderer);
+                break;
+            case Operation::CopyTexture:
+                SDL_RenderCopy(pRenderer, command.pTexture, command.HasSource ? &command.Source : nullptr, &command.Rect);
+                break;
+            case Operation::DrawLine:
+                setColor(command.Color);
+                SDL_RenderDrawLine(pRenderer, command.Rect.x, command.Rect.y, command.Rect.w, command.Rect.h);
+                break;
+            case Operation::DrawRect:
+                setColor(command.Color);
+                iter = Batch(iter - 1);
+                SDL_RenderDrawRects(pRenderer, m_batch.data(), static_cast<int>(m_batch.size()));
+                break;
+            case Operation::FillRect:
+                setColor(command.Color);
+                iter = Batch(iter - 1);
+                SDL_RenderFillRects(pRenderer, m_batch.data(), static_cast<int>(m_batch.size()));
+                break;
+            case Operation::SetClip:
+                SDL_RenderSetClipRect(pRenderer, command.HasSource ? &command.Rect : nullptr);
+                break;
+            case Operation::SetTarget:
+                SDL_SetRenderTarget(pRenderer, command.pTexture);
+                break;
+            case Operation::UpdateTexture:
+                SDL_UpdateTexture(command.pTexture, &command.Rect, m_pixels.data() + command.Pixels, command.Pitch);
+                break;
+            }
+        }
+
+        SDL_SetRenderTarget(pRenderer, nullptr);
+        SDL_RenderSetClipRect(pRenderer, nullptr);
+    }
+
+    void DisplayList::Reset(uint64_t frame)
+    {
+        m_commands.clear();
+        m_pixels.clear();
+        m_frame = frame;
+        m_timing = FrameTiming();
+    }
+
+    void DisplayList::SetClip(SDL_Rect const* clip)
+    {
+        // HasSource marks that there is a clip
+        auto& command = Add(Operation::SetClip);
+        if (clip != nullptr)
+        {
+            command.HasSource = true;
+            command.Rect = *clip;
+        }
+    }
+
+    void DisplayList::SetTarget(SDL_Texture* pTexture)
+    {
+        Add(Operation::SetTarget).pTexture = pTexture;
+    }
+
+    void DisplayList::Swap(DisplayList& other)
+    {
+        m_commands.swap(other.m_commands);
+        m_pixels.swap(other.m_pixels);
+        std::swap(m_frame, other.m_frame);
+        std::swap(m_timing, other.m_timing);
+    }
+
+    void DisplayList::UpdateTexture(SDL_Texture* pTexture, const SDL_Rect& area, const void* pixels, int pitch)
+    {
+        auto& command = Add(Operation::UpdateTexture);
+        command.pTexture = pTexture;
+        command.Rect = area;
+        command.Pixels = m_pixels.size();
+        command.Pitch = pitch;
+
+        auto first = static_cast<const uint8_t*>(pixels);
+        m_pixels.insert(m_pixels.end(), first, first + static_cast<size_t>(pitch) * area.h);
+    }
+
+} // namespace libsdlgui::detail
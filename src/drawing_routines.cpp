@@ -1,9 +1,21 @@
 #include "stdafx.h"
 #include "drawing_routines.hpp"
+#include "exceptions.hpp"
+#include "raster_cache.hpp"
+#include "trace_events.hpp"
 #include "window.hpp"
 
 namespace libsdlgui::detail
 {
+    namespace
+    {
+        // rounds the capacity of a streaming texture up to a multiple of 16 pixels
+        int RoundUpCapacity(int size)
+        {
+            return (size + 15) & ~15;
+        }
+    }
+
     void DrawChevron(Window* pWindow, const SDL_Rect& bounds, const SDL_Color& color, bool pointsUp)
     {
         const int Size = 2;
@@ -73,20 +85,79 @@ namespace libsdlgui::detail
         pWindow->DrawLine(endOne, endTwo, color);
     }
 
+    SDLTexture CreateTextureForSurface(Window const* pWindow, SDL_Surface* pSurface)
+    {
+        assert(pSurface->format->format == SDL_PIXELFORMAT_ARGB8888);
+
+        auto texture = pWindow->m_texturePool.Acquire(SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, pSurface->w, pSurface->h);
+        UpdateTexture(pWindow, texture, SDLRect(0, 0, pSurface->w, pSurface->h), pSurface->pixels, pSurface->pitch);
+        return texture;
+    }
+
     SDLTexture CreateTextureForText(Window const* pWindow, const std::string& text, Font const* font, const SDL_Color& fgColor, const SDL_Color& bgColor)
     {
         // if there is no text then bail
         if (text.length() == 0)
             return SDLTexture();
 
-        auto currentStyle = static_cast<Font::Attributes>(TTF_GetFontStyle(font->GetTtf()));
-        if (currentStyle != font->GetAttributes())
-            TTF_SetFontStyle(font->GetTtf(), static_cast<int>(font->GetAttributes()));
+        TraceSpan span("CreateTextureForText", "raster");
+
+        // the text is rasterized once for every window in the texture's format
+        auto sharedSurface = RasterCache::GetInstance()->GetText(font, text, fgColor, bgColor);
+        return CreateTextureForSurface(pWindow, *sharedSurface);
+    }
+
+    void UpdateTextureForText(Window const* pWindow, SDLTexture& texture, const std::string& text, Font const* font, const SDL_Color& fgColor, const SDL_Color& bgColor)
+    {
+        // keep the allocation for the next update
+        if (text.length() == 0)
+        {
+            texture.SetSize(0, 0);
+            return;
+        }
+
+        TraceSpan span("UpdateTextureForText", "raster");
+
+        auto sharedSurface = RasterCache::GetInstance()->GetText(font, text, fgColor, bgColor);
+        auto& textSurface = *sharedSurface;
+
+        int access = -1;
+        if (texture != nullptr)
+            SDL_QueryTexture(texture, nullptr, &access, nullptr, nullptr);
+
+        if (access != SDL_TEXTUREACCESS_STREAMING || textSurface->w > texture.GetCapacityWidth() || textSurface->h > texture.GetCapacityHeight())
+        {
+            // leave room for the text to grow by half before it's reallocated
+            auto capacityWidth = RoundUpCapacity(textSurface->w + textSurface->w / 2);
+            auto capacityHeight = RoundUpCapacity(textSurface->h);
+
+            texture = pWindow->m_texturePool.Acquire(SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, capacityWidth, capacityHeight);
+        }
 
-        auto textSurface = SDLSurface(TTF_RenderText_Shaded(font->GetTtf(), text.c_str(),
-            fgColor, bgColor));
+        texture.SetSize(textSurface->w, textSurface->h);
+        auto area = SDLRect(0, 0, textSurface->w, textSurface->h);
+
+        // frames the render thread hasn't replayed yet might still draw the texture's current
+        // text so the new text is uploaded by it after them rather than written in place
+        if (pWindow->m_renderThread != nullptr)
+        {
+            UpdateTexture(pWindow, texture, area, textSurface->pixels, textSurface->pitch);
+            return;
+        }
+
+        // convert the text straight into the texture's memory
+        void* pixels = nullptr;
+        int pitch = 0;
+        if (SDL_LockTexture(texture, &area, &pixels, &pitch) != 0)
+            throw SDLException("SDL_LockTexture failed with error '" + SDLGetError() + "'.");
+
+        {
+            SDLSurface target(SDL_CreateRGBSurfaceWithFormatFrom(pixels, area.w, area.h, 32, pitch, SDL_PIXELFORMAT_ARGB8888));
+            if (target != nullptr)
+                SDL_BlitSurface(textSurface, nullptr, target, nullptr);
+        }
 
-        return SDLTexture(SDL_CreateTextureFromSurface(pWindow->m_renderer, textSurface), textSurface->w, textSurface->h);
+        SDL_UnlockTexture(texture);
     }
 
 } // namespace libsdlgui::detail
@@ -11,6 +11,12 @@ namespace libsdlgui
         // empty
     }
 
+    bool DropdownBox::ContentBox::ClipsToParentImpl() const
+    {
+        // the content pops up outside of the drop-down box and any container it's in
+        return false;
+    }
+
     bool DropdownBox::ContentBox::IsSubControl(Control* pControl)
     {
         // walk the parent hierachy to see if the control
@@ -36,18 +42,22 @@ namespace libsdlgui
     DropdownBox::DropdownBox(Window* pWindow, const SDL_Rect& location) :
         Control(pWindow, location), m_content(pWindow, SDLRect(location.x, location.y + location.h, location.w, 0), 1, 10, this)
     {
+        // the keyboard and the wheel change the selection without opening the content
+        SetEventInterest(EventInterest::Keyboard | EventInterest::MouseWheel);
+
         m_content.SetHidden(true);
         m_content.RegisterForSelectionChangedCallback([this](auto item)
             {
                 m_texture = detail::CreateTextureForText(GetWindow(), item, detail::GetFont(GetWindow()), GetForegroundColor(), GetBackgroundColor());
+                Invalidate();
                 m_content.SetHidden(true);
 
                 if (m_callback != nullptr)
                     m_callback(item);
             });
 
-        // default the z-order to be above us
-        detail::SetZOrder(&m_content, detail::GetZOrder(this) + 1);
+        // the content pops up above the controls around us
+        m_content.SetZLayer(ZLayer::Popup);
 
         SetBorderSize(1);
         SetBorderColor(SDLColor(0, 128, 0, 0));
@@ -129,12 +139,6 @@ namespace libsdlgui
         }
     }
 
-    void DropdownBox::OnZOrderChanged()
-    {
-        // our z-order changed, keep the content box just above us
-        detail::SetZOrder(&m_content, detail::GetZOrder(this)+1);
-    }
-
     void DropdownBox::RegisterForSelectionChangedCallback(const SelectionChangedCallback& callback)
     {
         m_callback = callback;
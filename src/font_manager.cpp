@@ -1,6 +1,7 @@
 #include "stdafx.h"
 #include "font_manager.hpp"
 #include "helpers.hpp"
+#include "trace_events.hpp"
 
 namespace libsdlgui
 {
@@ -29,15 +30,18 @@ namespace libsdlgui
                     return static_cast<uint8_t>(std::tolower(c));
                 });
 
-            auto fontIter = m_cache.find(lowerName);
+            // the same typeface can be loaded in several sizes and styles
+            auto key = lowerName + ":" + std::to_string(size) + ":" + std::to_string(static_cast<int>(attributes));
+            auto fontIter = m_cache.find(key);
             if (fontIter != m_cache.end())
                 return fontIter->second.get();
 
+            TraceSpan span("FontManager::LoadFont", "io");
             TTFFont ttf(m_fonts / (name + ".ttf"), size);
             auto font = std::make_unique<Font>(ttf, name, size, attributes);
             auto pFont = font.get();
 
-            m_cache.insert(FontCacheItem(lowerName, std::move(font)));
+            m_cache.insert(FontCacheItem(key, std::move(font)));
             return pFont;
         }
     }
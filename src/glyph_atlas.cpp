@@ -0,0 +1,35 @@
+#include "stdafx.h"
+#include "glyph_atlas.hpp"
+#include "raster_cache.hpp"
+#include "window.hpp"
+
+namespace libsdlgui::detail
+{
+    const char GlyphAtlas::Characters[] = "+-.0123456789abcdefinp";
+
+    GlyphAtlas::GlyphAtlas(Window const* pWindow, Font const* font, const SDL_Color& fgColor, const SDL_Color& bgColor) :
+        m_pFont(font), m_fgColor(fgColor), m_bgColor(bgColor)
+    {
+        // the glyphs are rasterized once for every window, each window uploads them to its own renderer
+        auto raster = RasterCache::GetInstance()->GetGlyphs(font, fgColor, bgColor);
+        m_glyphs = raster->Glyphs;
+
+        m_texture = CreateTextureForSurface(pWindow, raster->Surface);
+        SDL_SetTextureBlendMode(m_texture, SDL_BLENDMODE_BLEND);
+    }
+
+    bool GlyphAtlas::Matches(Font const* font, const SDL_Color& fgColor, const SDL_Color& bgColor) const
+    {
+        return m_pFont == font && m_fgColor == fgColor && m_bgColor == bgColor;
+    }
+
+    int GlyphAtlas::Measure(const char* first, const char* last) const
+    {
+        int width = 0;
+        for (; first != last; ++first)
+            width += GetGlyph(*first).w;
+
+        return width;
+    }
+
+} // namespace libsdlgui::detail
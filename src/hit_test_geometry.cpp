@@ -0,0 +1,131 @@
+#include "stdafx.h"
+#include "hit_test_geometry.hpp"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define LIBSDLGUI_HITTEST_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define LIBSDLGUI_HITTEST_SSE2
+#endif
+
+namespace libsdlgui::detail
+{
+    namespace
+    {
+        // returns the position of the highest bit set in mask, mask must be non-zero
+        int HighestBit(uint32_t mask)
+        {
+            int bit = 0;
+            while (mask >>= 1)
+                ++bit;
+
+            return bit;
+        }
+    }
+
+    HitTestGeometry::HitTestGeometry() : m_count(0)
+    {
+        // empty
+    }
+
+    int HitTestGeometry::FindTopmost(const SDL_Point& point) const
+    {
+        // the arrays are padded to a multiple of BlockSize so every
+        // block can be loaded without handling a partial tail.
+        auto padded = m_visible.size();
+
+#if defined(LIBSDLGUI_HITTEST_AVX2)
+        auto px = _mm256_set1_epi32(point.x);
+        auto py = _mm256_set1_epi32(point.y);
+
+        // walk down from the highest z-order so the first hit is the topmost
+        for (auto base = static_cast<ptrdiff_t>(padded) - 8; base >= 0; base -= 8)
+        {
+            auto left = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&m_left[base]));
+            auto top = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&m_top[base]));
+            auto right = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&m_right[base]));
+            auto bottom = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&m_bottom[base]));
+            auto visible = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(&m_visible[base]));
+
+            auto outside = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpgt_epi32(left, px), _mm256_cmpgt_epi32(px, right)),
+                _mm256_or_si256(_mm256_cmpgt_epi32(top, py), _mm256_cmpgt_epi32(py, bottom)));
+
+            auto hits = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_andnot_si256(outside, visible))));
+            if (hits != 0)
+                return static_cast<int>(base) + HighestBit(hits);
+        }
+
+        return -1;
+#elif defined(LIBSDLGUI_HITTEST_SSE2)
+        auto px = _mm_set1_epi32(point.x);
+        auto py = _mm_set1_epi32(point.y);
+
+        // walk down from the highest z-order so the first hit is the topmost
+        for (auto base = static_cast<ptrdiff_t>(padded) - 4; base >= 0; base -= 4)
+        {
+            auto left = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&m_left[base]));
+            auto top = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&m_top[base]));
+            auto right = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&m_right[base]));
+            auto bottom = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&m_bottom[base]));
+            auto visible = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&m_visible[base]));
+
+            auto outside = _mm_or_si128(
+                _mm_or_si128(_mm_cmpgt_epi32(left, px), _mm_cmpgt_epi32(px, right)),
+                _mm_or_si128(_mm_cmpgt_epi32(top, py), _mm_cmpgt_epi32(py, bottom)));
+
+            auto hits = static_cast<uint32_t>(_mm_movemask_ps(_mm_castsi128_ps(_mm_andnot_si128(outside, visible))));
+            if (hits != 0)
+                return static_cast<int>(base) + HighestBit(hits);
+        }
+
+        return -1;
+#else
+        return FindTopmostScalar(point, padded);
+#endif
+    }
+
+    int HitTestGeometry::FindTopmostScalar(const SDL_Point& point, size_t end) const
+    {
+        for (auto i = static_cast<ptrdiff_t>(end) - 1; i > -1; --i)
+        {
+            // same bounds test as SDLPointInRect
+            if (m_visible[i] != 0 && point.x >= m_left[i] && point.x <= m_right[i] &&
+                point.y >= m_top[i] && point.y <= m_bottom[i])
+                return static_cast<int>(i);
+        }
+
+        return -1;
+    }
+
+    void HitTestGeometry::Resize(size_t count)
+    {
+        m_count = count;
+
+        // round up to a whole number of blocks
+        auto padded = ((count + BlockSize - 1) / BlockSize) * BlockSize;
+        m_left.assign(padded, 0);
+        m_top.assign(padded, 0);
+        m_right.assign(padded, 0);
+        m_bottom.assign(padded, 0);
+        m_visible.assign(padded, 0);
+    }
+
+    void HitTestGeometry::Set(size_t index, const SDL_Rect& bounds, bool isHidden)
+    {
+        assert(index < m_count);
+        m_left[index] = bounds.x;
+        m_top[index] = bounds.y;
+        m_right[index] = bounds.x + bounds.w;
+        m_bottom[index] = bounds.y + bounds.h;
+        SetHidden(index, isHidden);
+    }
+
+    void HitTestGeometry::SetHidden(size_t index, bool isHidden)
+    {
+        assert(index < m_count);
+        m_visible[index] = isHidden ? 0 : -1;
+    }
+
+} // namespace libsdlgui::detail
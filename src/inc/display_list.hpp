@@ -0,0 +1,128 @@
+#ifndef DISPLAYLIST_HPP
+#define DISPLAYLIST_HPP
+
+#include <SDL_pixels.h>
+#include <SDL_rect.h>
+#include <SDL_render.h>
+#include <stdint.h>
+#include <vector>
+
+namespace libsdlgui::detail
+{
+    // performance counter values for measuring a frame once it's presented, 0 if there is none
+    struct FrameTiming
+    {
+        // when the window started rendering the frame
+        uint64_t Start;
+
+        // when the oldest input the frame reflects was tracked and the milliseconds it waited in the queue before
+        uint64_t InputCounter;
+        uint32_t InputDelay;
+    };
+
+    // the drawing of a frame recorded as commands so it can be replayed on the renderer later,
+    // possibly by another thread.  coordinates are in the current target's coordinates.  controls
+    // keep the list of their own drawing in window coordinates, which is added to the frame's list.
+    class DisplayList
+    {
+    private:
+        enum class Operation : uint8_t
+        {
+            Clear,
+            CopyTexture,
+            DrawLine,
+            DrawRect,
+            FillRect,
+            SetClip,
+            SetTarget,
+            UpdateTexture
+        };
+
+        struct Command
+        {
+            Operation Op;
+            bool HasSource;
+            SDL_Color Color;
+
+            // the destination, clip, rectangle drawn or area updated.  a line's end points are x, y and w, h.
+            SDL_Rect Rect;
+            SDL_Rect Source;
+            SDL_Texture* pTexture;
+
+            // where an update's pixels start in the list's pixels and the length of their rows
+            size_t Pixels;
+            int Pitch;
+        };
+
+        std::vector<Command> m_commands;
+        std::vector<uint8_t> m_pixels;
+        uint64_t m_frame;
+        FrameTiming m_timing;
+
+        // rectangles of consecutive commands that are drawn with a single call
+        mutable std::vector<SDL_Rect> m_batch;
+
+        Command& Add(Operation op);
+
+        // gathers the rectangles of the commands from first on with the same operation and color
+        // as first into the batch, returns the command after the last one gathered
+        std::vector<Command>::const_iterator Batch(std::vector<Command>::const_iterator first) const;
+
+    public:
+        DisplayList() : m_frame(0), m_timing() {}
+
+        // appends a list recorded later, this list takes on its frame number and its start.  the
+        // oldest input is kept as the later list also reflects it.
+        void Append(const DisplayList& later);
+
+        // appends the commands of a control's retained list moved by offset
+        void AppendRetained(const DisplayList& retained, const SDL_Point& offset);
+
+        // returns true if the list draws into the window rather than only updating textures
+        bool DrawsWindow() const;
+
+        // removes the commands that draw into the window so only those that update textures remain.
+        // the window's content is replaced by any later frame, the textures keep theirs.
+        void DropWindowDrawing();
+
+        // gets the number of the frame the list was recorded for
+        uint64_t GetFrame() const { return m_frame; }
+
+        // gets the timing of the frame the list draws
+        const FrameTiming& GetTiming() const { return m_timing; }
+
+        // returns true if nothing has been recorded
+        bool IsEmpty() const { return m_commands.empty(); }
+
+        // clears the commands and the timing to record the specified frame, their memory is kept
+        void Reset(uint64_t frame);
+
+        // draws the commands with the renderer, the window is the target afterwards.  consecutive
+        // rectangles of the same color are drawn with a single call, including those of different controls.
+        void Replay(SDL_Renderer* pRenderer) const;
+
+        // sets the timing of the frame the list draws
+        void SetTiming(const FrameTiming& timing) { m_timing = timing; }
+
+        // exchanges the content of the lists
+        void Swap(DisplayList& other);
+
+        void Clear(const SDL_Color& color);
+        void CopyTexture(SDL_Texture* pTexture, SDL_Rect const* source, const SDL_Rect& destination);
+        void DrawLine(const SDL_Point& p1, const SDL_Point& p2, const SDL_Color& color);
+        void DrawRect(const SDL_Rect& rect, const SDL_Color& color);
+        void FillRect(const SDL_Rect& rect, const SDL_Color& color);
+
+        // sets the clip rect of the current target, nullptr for none
+        void SetClip(SDL_Rect const* clip);
+
+        // sets the texture drawn into, nullptr for the window.  the clip is reset.
+        void SetTarget(SDL_Texture* pTexture);
+
+        // replaces the pixels of an area of a texture, the pixels are copied into the list
+        void UpdateTexture(SDL_Texture* pTexture, const SDL_Rect& area, const void* pixels, int pitch);
+    };
+
+} // namespace libsdlgui::detail
+
+#endif // DISPLAYLIST_HPP
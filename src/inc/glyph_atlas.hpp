@@ -0,0 +1,51 @@
+#ifndef GLYPHATLAS_HPP
+#define GLYPHATLAS_HPP
+
+#include <array>
+#include "font.hpp"
+#include "sdl_helpers.hpp"
+
+namespace libsdlgui
+{
+    // forward declaration
+    class Window;
+}
+
+namespace libsdlgui::detail
+{
+    // a texture holding the glyphs needed to draw numbers in a font and color,
+    // rasterized once so numbers can be composed by copying cells from it.
+    class GlyphAtlas
+    {
+    private:
+        Font const* m_pFont;
+        SDL_Color m_fgColor;
+        SDL_Color m_bgColor;
+        SDLTexture m_texture;
+        std::array<SDL_Rect, 128> m_glyphs;
+
+    public:
+        // the characters in the atlas, they cover everything std::to_chars produces
+        static const char Characters[];
+
+        GlyphAtlas(Window const* pWindow, Font const* font, const SDL_Color& fgColor, const SDL_Color& bgColor);
+
+        // gets the glyph's cell within the texture, its width is zero if the character isn't in the atlas
+        const SDL_Rect& GetGlyph(char c) const { return m_glyphs[static_cast<unsigned char>(c) & 0x7f]; }
+
+        // gets the height of the glyphs
+        int GetHeight() const { return m_texture.GetHeight(); }
+
+        // gets the texture holding the glyphs
+        const SDLTexture& GetTexture() const { return m_texture; }
+
+        // returns true if the atlas was rasterized with the specified font and colors
+        bool Matches(Font const* font, const SDL_Color& fgColor, const SDL_Color& bgColor) const;
+
+        // gets the width of the specified characters
+        int Measure(const char* first, const char* last) const;
+    };
+
+} // namespace libsdlgui::detail
+
+#endif // GLYPHATLAS_HPP
@@ -1,12 +1,27 @@
 #ifndef HELPERS_HPP
 #define HELPERS_HPP
 
+#include <SDL_events.h>
+#include <SDL_pixels.h>
 #include <string>
 
 namespace libsdlgui::detail
 {
+	// gets the id of the window the event was sent to, or 0 if it isn't specific to a window
+	uint32_t GetEventWindowId(const SDL_Event& sdlEvent);
+
+	// packs a color into a single value so it can be used as a key
+	inline uint32_t PackColor(const SDL_Color& color)
+	{
+		return (static_cast<uint32_t>(color.r) << 24) | (static_cast<uint32_t>(color.g) << 16) |
+			(static_cast<uint32_t>(color.b) << 8) | color.a;
+	}
+
 	std::string SafeGetEnv(const std::string& name);
 
+	// sets the id of the window the event was sent to, events that aren't specific to a window are unchanged
+	void SetEventWindowId(SDL_Event& sdlEvent, uint32_t windowId);
+
 } // namespace libsdlgui::detail
 
 #endif // HELPERS_HPP
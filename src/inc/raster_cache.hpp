@@ -0,0 +1,71 @@
+#ifndef RASTERCACHE_HPP
+#define RASTERCACHE_HPP
+
+#include <array>
+#include "font.hpp"
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include "sdl_helpers.hpp"
+#include "singleton.hpp"
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace libsdlgui::detail
+{
+    // the glyphs needed to draw numbers laid out in a single row
+    struct GlyphRaster
+    {
+        SDLSurface Surface;
+        std::array<SDL_Rect, 128> Glyphs;
+
+        GlyphRaster(SDL_Surface* pSurface, const std::array<SDL_Rect, 128>& glyphs) : Surface(pSurface), Glyphs(glyphs) {}
+    };
+
+    // rasterizations of text shared by every window in the process.  rasterizing is
+    // independent of the renderer so a window only uploads what another window has
+    // already rasterized into its own textures.  surfaces are in SDL_PIXELFORMAT_ARGB8888.
+    // any thread can use the cache, each font is used by one thread at a time.
+    class RasterCacheType
+    {
+    private:
+        friend void Singleton<RasterCacheType>::Initialize();
+        friend void Singleton<RasterCacheType>::Destroy();
+
+        // the most memory used by the rasterized text before the least recently used is evicted
+        static const size_t MaxTextBytes = 4 * 1024 * 1024;
+
+        using ColorsKey = std::tuple<Font const*, uint32_t, uint32_t>;
+        using TextKey = std::tuple<Font const*, uint32_t, uint32_t, std::string>;
+        using TextEntry = std::pair<TextKey, std::shared_ptr<SDLSurface>>;
+
+        std::mutex m_lock;
+        std::map<ColorsKey, std::shared_ptr<GlyphRaster>> m_glyphs;
+        std::list<TextEntry> m_text;
+        std::map<TextKey, std::list<TextEntry>::iterator> m_textIndex;
+        size_t m_textBytes;
+
+        RasterCacheType();
+        ~RasterCacheType();
+
+        // renders the text with the font's attributes, the result is in the palettized format TTF produces
+        SDLSurface RenderShaded(Font const* font, const char* text, const SDL_Color& fgColor, const SDL_Color& bgColor);
+
+    public:
+        // gets the glyphs for drawing numbers in the specified font and colors, they're rasterized on first use
+        std::shared_ptr<GlyphRaster> GetGlyphs(Font const* font, const SDL_Color& fgColor, const SDL_Color& bgColor);
+
+        // gets the specified text rasterized in the specified font and colors, the text must not be empty
+        std::shared_ptr<SDLSurface> GetText(Font const* font, const std::string& text, const SDL_Color& fgColor, const SDL_Color& bgColor);
+
+        // rasterizes the texts that aren't cached on the task pool so they're ready when they're drawn
+        void Prefetch(Font const* font, std::vector<std::string> texts, const SDL_Color& fgColor, const SDL_Color& bgColor);
+    };
+
+    using RasterCache = Singleton<RasterCacheType>;
+
+} // namespace libsdlgui::detail
+
+#endif // RASTERCACHE_HPP
@@ -0,0 +1,70 @@
+#ifndef RENDERTHREAD_HPP
+#define RENDERTHREAD_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include "display_list.hpp"
+#include "latency_histogram.hpp"
+#include <memory>
+#include <mutex>
+#include <SDL_render.h>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+namespace libsdlgui::detail
+{
+    // replays the display lists published by the UI thread and presents them on a thread of its own
+    // so the UI thread never waits for the renderer to draw or present.  the lists also carry the
+    // texture uploads so they're done in order with the frames.  the renderer lock is held while
+    // replaying and presenting, the UI thread holds it while it creates or destroys textures.  the latest list is
+    // presented, a list that's replaced before it's presented keeps only its texture updates and
+    // drawing into textures as that content is used by the later frames.
+    class RenderThread
+    {
+    private:
+        SDL_Renderer* m_pRenderer;
+        std::mutex& m_rendererLock;
+        std::mutex m_lock;
+        std::condition_variable m_published;
+        std::condition_variable m_idle;
+        std::unique_ptr<DisplayList> m_pPublished;
+        std::unique_ptr<DisplayList> m_pSpare;
+        std::atomic<uint64_t> m_presentedFrame;
+
+        // the frame times and input latencies in microseconds measured after presenting that haven't been taken
+        std::vector<uint64_t> m_frameTimes;
+        std::vector<uint64_t> m_inputLatencies;
+        bool m_busy;
+        bool m_stopping;
+        std::thread m_thread;
+
+        // replays and presents the published lists until stopped
+        void Run();
+
+    public:
+        RenderThread(SDL_Renderer* pRenderer, std::mutex& rendererLock);
+        RenderThread(const RenderThread&) = delete;
+        RenderThread& operator=(const RenderThread&) = delete;
+
+        // presents the list that was published last then stops the thread
+        ~RenderThread();
+
+        // drops the list that's waiting to be replayed and waits for the thread to finish the one it's
+        // replaying, afterwards the thread doesn't refer to any texture until a list is published again
+        void Discard();
+
+        // gets the number of the last frame that's been presented or replaced, the textures
+        // used by it and by the frames before it are no longer referenced by the thread.
+        uint64_t GetPresentedFrame() const { return m_presentedFrame; }
+
+        // hands the recorded list to the thread, recorded is left empty for the next frame
+        void Publish(DisplayList& recorded);
+
+        // records the frame times and input latencies measured since the last call in the histograms
+        void TakeMeasurements(LatencyHistogram& frameTimes, LatencyHistogram& inputLatency);
+    };
+
+} // namespace libsdlgui::detail
+
+#endif // RENDERTHREAD_HPP
@@ -0,0 +1,233 @@
+#include "stdafx.h"
+#include "helpers.hpp"
+#include "input_recording.hpp"
+#include <SDL_hints.h>
+#include "window.hpp"
+
+namespace libsdlgui
+{
+    namespace detail
+    {
+        namespace
+        {
+            const char RecordingMagic[4] = { 'L', 'S', 'G', 'R' };
+            const uint16_t RecordingVersion = 1;
+
+            // returns the number of bytes of the SDL_Event union used by the specified
+            // event type, or zero if events of that type aren't recorded.
+            uint16_t GetEventPayloadSize(uint32_t type)
+            {
+                switch (type)
+                {
+                case SDL_KEYDOWN:
+                case SDL_KEYUP:
+                    return sizeof(SDL_KeyboardEvent);
+                case SDL_MOUSEBUTTONDOWN:
+                case SDL_MOUSEBUTTONUP:
+                    return sizeof(SDL_MouseButtonEvent);
+                case SDL_MOUSEWHEEL:
+                    return sizeof(SDL_MouseWheelEvent);
+                case SDL_MOUSEMOTION:
+                    return sizeof(SDL_MouseMotionEvent);
+                case SDL_TEXTINPUT:
+                    return sizeof(SDL_TextInputEvent);
+                case SDL_WINDOWEVENT:
+                    return sizeof(SDL_WindowEvent);
+                case SDL_QUIT:
+                    return sizeof(SDL_QuitEvent);
+                }
+
+                return 0;
+            }
+
+            template <typename T>
+            void Write(std::ofstream& stream, const T& value)
+            {
+                stream.write(reinterpret_cast<const char*>(&value), sizeof(T));
+            }
+
+            template <typename T>
+            bool Read(std::ifstream& stream, T& value)
+            {
+                return static_cast<bool>(stream.read(reinterpret_cast<char*>(&value), sizeof(T)));
+            }
+        }
+
+        InputRecorder::InputRecorder(const std::filesystem::path& fileName, const Dimentions& dimentions, uint32_t startTicks) :
+            m_stream(fileName, std::ios::out | std::ios::binary | std::ios::trunc), m_start(startTicks)
+        {
+            if (!m_stream)
+                throw std::runtime_error("failed to create input recording '" + fileName.string() + "'");
+
+            WriteHeader(dimentions);
+        }
+
+        void InputRecorder::RecordEvent(const SDL_Event& sdlEvent, uint32_t ticks)
+        {
+            auto size = GetEventPayloadSize(sdlEvent.type);
+            if (size == 0)
+                return;
+
+            WriteRecord(InputRecordKind::Event, ticks);
+            Write(m_stream, size);
+            m_stream.write(reinterpret_cast<const char*>(&sdlEvent), size);
+        }
+
+        void InputRecorder::RecordFrame(uint32_t ticks)
+        {
+            WriteRecord(InputRecordKind::Frame, ticks);
+        }
+
+        void InputRecorder::WriteHeader(const Dimentions& dimentions)
+        {
+            m_stream.write(RecordingMagic, sizeof(RecordingMagic));
+            Write(m_stream, RecordingVersion);
+            Write(m_stream, static_cast<uint16_t>(0));
+            Write(m_stream, static_cast<int32_t>(dimentions.W));
+            Write(m_stream, static_cast<int32_t>(dimentions.H));
+        }
+
+        void InputRecorder::WriteRecord(InputRecordKind kind, uint32_t ticks)
+        {
+            Write(m_stream, kind);
+            Write(m_stream, ticks - m_start);
+        }
+    }
+
+    InputReplay::InputReplay(const std::filesystem::path& fileName) :
+        m_dims(0, 0)
+    {
+        std::ifstream stream(fileName, std::ios::in | std::ios::binary);
+        if (!stream)
+            throw std::runtime_error("failed to open input recording '" + fileName.string() + "'");
+
+        char magic[sizeof(detail::RecordingMagic)];
+        uint16_t version = 0;
+        uint16_t reserved = 0;
+        int32_t width = 0;
+        int32_t height = 0;
+
+        if (!stream.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), detail::RecordingMagic))
+            throw std::runtime_error("'" + fileName.string() + "' is not an input recording");
+
+        if (!detail::Read(stream, version) || version != detail::RecordingVersion)
+            throw std::runtime_error("unsupported version of input recording '" + fileName.string() + "'");
+
+        if (!detail::Read(stream, reserved) || !detail::Read(stream, width) || !detail::Read(stream, height))
+            throw std::runtime_error("input recording '" + fileName.string() + "' is truncated");
+
+        m_dims = Dimentions(width, height);
+
+        Record record;
+        while (detail::Read(stream, record.Kind))
+        {
+            if (!detail::Read(stream, record.Ticks))
+                throw std::runtime_error("input recording '" + fileName.string() + "' is truncated");
+
+            record.Event = {};
+            if (record.Kind == detail::InputRecordKind::Event)
+            {
+                uint16_t size = 0;
+                if (!detail::Read(stream, size) || size > sizeof(SDL_Event) ||
+                    !stream.read(reinterpret_cast<char*>(&record.Event), size))
+                    throw std::runtime_error("input recording '" + fileName.string() + "' is truncated");
+            }
+            else if (record.Kind != detail::InputRecordKind::Frame)
+            {
+                throw std::runtime_error("input recording '" + fileName.string() + "' is corrupt");
+            }
+
+            m_records.push_back(record);
+        }
+    }
+
+    size_t InputReplay::GetFrameCount() const
+    {
+        return std::count_if(m_records.begin(), m_records.end(), [](const Record& record)
+            {
+                return record.Kind == detail::InputRecordKind::Frame;
+            });
+    }
+
+    bool InputReplay::Run(Window* pWindow, ReplaySpeed speed) const
+    {
+        // restores the window's tick source even if dispatching throws
+        class TickSourceHolder
+        {
+        private:
+            Window* m_pWindow;
+
+        public:
+            TickSourceHolder(Window* pWindow, const Window::TickSource& tickSource) : m_pWindow(pWindow)
+            {
+                m_pWindow->SetTickSource(tickSource);
+            }
+
+            ~TickSourceHolder()
+            {
+                m_pWindow->SetTickSource(nullptr);
+            }
+        };
+
+        // the recording might have been made with a different window size
+        if (pWindow->GetDimentions() != m_dims)
+        {
+            SDL_Event resizeEvent = {};
+            resizeEvent.type = SDL_WINDOWEVENT;
+            resizeEvent.window.timestamp = SDL_GetTicks();
+            resizeEvent.window.event = SDL_WINDOWEVENT_SIZE_CHANGED;
+            resizeEvent.window.data1 = m_dims.W;
+            resizeEvent.window.data2 = m_dims.H;
+            pWindow->TranslateEvent(resizeEvent);
+        }
+
+        // start from the window's current time so ticks never go backwards
+        auto baseTicks = pWindow->GetTicks();
+        uint32_t recordTicks = 0;
+        TickSourceHolder holder(pWindow, [baseTicks, &recordTicks]()
+            {
+                return baseTicks + recordTicks;
+            });
+
+        auto frequency = SDL_GetPerformanceFrequency();
+        auto start = SDL_GetPerformanceCounter();
+        bool quit = false;
+
+        for (auto& record : m_records)
+        {
+            recordTicks = record.Ticks;
+
+            if (speed == ReplaySpeed::Original)
+            {
+                auto deadline = start + (static_cast<uint64_t>(record.Ticks) * frequency) / 1000;
+                auto now = SDL_GetPerformanceCounter();
+                if (now < deadline)
+                    SDL_Delay(static_cast<uint32_t>(((deadline - now) * 1000) / frequency));
+            }
+
+            if (record.Kind == detail::InputRecordKind::Frame)
+            {
+                pWindow->Render();
+            }
+            else
+            {
+                // the event is stamped with the time it's dispatched so the input latency measures this
+                // replay rather than the recorded session, and it's addressed to the replaying window as
+                // the recording was made with a different one
+                auto sdlEvent = record.Event;
+                sdlEvent.common.timestamp = SDL_GetTicks();
+                detail::SetEventWindowId(sdlEvent, pWindow->GetWindowId());
+                quit |= pWindow->TranslateEvent(sdlEvent);
+            }
+        }
+
+        return quit;
+    }
+
+    void InputReplay::UseHeadlessVideo()
+    {
+        // the dummy driver's windows draw into memory with the software renderer
+        SDL_SetHint(SDL_HINT_VIDEODRIVER, "dummy");
+    }
+
+} // namespace libsdlgui
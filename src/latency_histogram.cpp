@@ -0,0 +1,95 @@
+#include "stdafx.h"
+#include "latency_histogram.hpp"
+
+namespace libsdlgui
+{
+    LatencyHistogram::LatencyHistogram()
+    {
+        Reset();
+    }
+
+    uint32_t LatencyHistogram::GetBucketIndex(uint64_t value)
+    {
+        if (value < SubBucketCount)
+            return static_cast<uint32_t>(value);
+
+        // find the most significant bit then keep the six bits starting at it
+        uint32_t msb = 0;
+        for (auto v = value; v > 1; v >>= 1)
+            ++msb;
+
+        auto shift = msb - 5;
+        auto index = SubBucketCount + (shift - 1) * SubBucketHalfCount + static_cast<uint32_t>((value >> shift) - SubBucketHalfCount);
+        if (index >= BucketCount)
+            index = BucketCount - 1;
+
+        return index;
+    }
+
+    uint64_t LatencyHistogram::GetBucketUpperBound(uint32_t index)
+    {
+        if (index < SubBucketCount)
+            return index;
+
+        auto shift = ((index - SubBucketCount) / SubBucketHalfCount) + 1;
+        auto sub = static_cast<uint64_t>((index - SubBucketCount) % SubBucketHalfCount) + SubBucketHalfCount;
+        return ((sub + 1) << shift) - 1;
+    }
+
+    double LatencyHistogram::GetMean() const
+    {
+        if (m_total == 0)
+            return 0.0;
+
+        return static_cast<double>(m_sum) / static_cast<double>(m_total);
+    }
+
+    uint64_t LatencyHistogram::GetPercentile(double percentile) const
+    {
+        if (m_total == 0)
+            return 0;
+
+        if (percentile <= 0.0)
+            return GetMin();
+        else if (percentile >= 100.0)
+            return m_max;
+
+        // number of values that must be at or below the result, rounded up (the nearest-rank definition)
+        // multiplying first keeps it exact for whole percentiles so e.g. p99 of 100 values is the 99th
+        auto target = static_cast<uint64_t>(std::ceil(percentile * static_cast<double>(m_total) / 100.0));
+        if (target == 0)
+            target = 1;
+
+        uint64_t seen = 0;
+        for (uint32_t i = 0; i < BucketCount; ++i)
+        {
+            seen += m_counts[i];
+            if (seen >= target)
+                return std::min(GetBucketUpperBound(i), m_max);
+        }
+
+        return m_max;
+    }
+
+    void LatencyHistogram::Record(uint64_t microseconds)
+    {
+        ++m_counts[GetBucketIndex(microseconds)];
+        ++m_total;
+        m_sum += microseconds;
+
+        if (microseconds < m_min)
+            m_min = microseconds;
+        if (microseconds > m_max)
+            m_max = microseconds;
+    }
+
+    void LatencyHistogram::Reset()
+    {
+        m_counts.fill(0);
+        m_total = 0;
+        m_sum = 0;
+        m_min = UINT64_MAX;
+        m_max = 0;
+    }
+
+} // namespace libsdlgui
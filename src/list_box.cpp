@@ -1,5 +1,7 @@
 #include "stdafx.h"
 #include "list_box.hpp"
+#include "raster_cache.hpp"
+#include "task_pool.hpp"
 #include "window.hpp"
 
 namespace libsdlgui
@@ -11,11 +13,16 @@ namespace libsdlgui
         m_highlighted(UINT32_MAX),
         m_minVisible(minVisible),
         m_maxVisible(maxVisible),
-        m_visStart(0),
+        m_scrollOffset(0),
         m_vertScrollbar(pWindow, location, this),
+        m_viewportOffset(0),
+        m_prefetchFirst(UINT32_MAX),
         m_scrollRequiredFocus(scrollRequiresFocus),
-        m_highlightOnMouseMotion(highlightOnMouseMotion)
+        m_highlightOnMouseMotion(highlightOnMouseMotion),
+        m_viewportValid(false)
     {
+        SetEventInterest(EventInterest::Keyboard | EventInterest::MouseMotion | EventInterest::MouseWheel);
+
         auto myLoc = GetLocation();
 
         // place the scroll bar in the right side of the control
@@ -28,11 +35,15 @@ namespace libsdlgui
         SetBorderColor(SDLColor(0, 128, 0, 0));
         SetBorderSize(1);
 
-        // default the z-order to be above us
-        detail::SetZOrder(&m_vertScrollbar, detail::GetZOrder(this) + 1);
+        // the content is scrolled in pixels, the arrows move it by an item and paging by the visible items
+        m_vertScrollbar.SetSmallChange(m_itemHeight);
+        m_vertScrollbar.SetLargeChange(m_itemHeight * m_maxVisible);
+        m_vertScrollbar.SetPageSize(m_itemHeight * m_maxVisible);
         m_vertScrollbar.RegisterForScrollCallback([this](const detail::ScrollEventData& eventData)
             {
-                m_visStart = eventData.NewValue();
+                m_scrollOffset = eventData.NewValue();
+                PrefetchItems(eventData.Direction());
+                Invalidate();
             });
 
         // hide the scrollbar by default
@@ -41,20 +52,18 @@ namespace libsdlgui
 
     void ListBox::AddItem(const std::string& item)
     {
+        // the textures are created when the item is first scrolled into view
         m_items.push_back(item);
-        auto texture = detail::CreateTextureForText(GetWindow(), item, detail::GetFont(GetWindow()), GetForegroundColor(), GetBackgroundColor());
-        auto highlight = detail::CreateTextureForText(GetWindow(), item, detail::GetFont(GetWindow()), GetBackgroundColor(), GetForegroundColor());
-
-        assert(static_cast<uint32_t>(texture.GetHeight()) == m_itemHeight);
-        m_textures.push_back(std::tuple<SDLTexture, SDLTexture, bool>(std::move(texture), std::move(highlight), false));
+        m_textures.push_back(std::tuple<SDLTexture, SDLTexture, bool>(SDLTexture(), SDLTexture(), false));
+        InvalidateViewport();
 
-        // set the max based on the total item size minus the
-        // max items visible paying attention to underflow
+        // set the max based on the total height of the items minus
+        // the max items visible paying attention to underflow
         auto vertMax = m_items.size() - m_maxVisible;
         if (vertMax > m_items.size())
             vertMax = 0;
 
-        m_vertScrollbar.SetMaximum(static_cast<uint32_t>(vertMax));
+        m_vertScrollbar.SetMaximum(static_cast<uint32_t>(vertMax) * m_itemHeight);
 
         // if the count of items is greater than the minimum
         // number to display we need to resize the control up
@@ -80,25 +89,41 @@ namespace libsdlgui
         auto myLoc = GetLocation();
 
         // select the highlighted texture for the item the mouse is over
-        uint32_t index = ((mouseLoc.y - myLoc.y) / m_itemHeight) + m_visStart;
+        uint32_t index = (static_cast<uint32_t>(mouseLoc.y - myLoc.y) + m_scrollOffset) / m_itemHeight;
         if (index >= m_items.size())
             return UINT32_MAX;
 
         return index;
     }
 
-    uint32_t ListBox::GetVisCount() const
+    const SDLTexture& ListBox::GetItemTexture(size_t index, bool highlighted)
     {
-        // return the number of items that are visible
-        // with respect to the min and max display bounds.
+        auto& texture = highlighted ? std::get<1>(m_textures[index]) : std::get<0>(m_textures[index]);
+
+        // only the items that have been scrolled into view are rasterized
+        if (texture == nullptr)
+        {
+            if (highlighted)
+                texture = detail::CreateTextureForText(GetWindow(), m_items[index], detail::GetFont(GetWindow()), GetBackgroundColor(), GetForegroundColor());
+            else
+                texture = detail::CreateTextureForText(GetWindow(), m_items[index], detail::GetFont(GetWindow()), GetForegroundColor(), GetBackgroundColor());
+
+            assert(texture == nullptr || static_cast<uint32_t>(texture.GetHeight()) == m_itemHeight);
+        }
 
-        auto visCount = m_items.size();
-        if (visCount > m_maxVisible)
-            visCount = m_maxVisible;
-        else if (visCount < m_minVisible)
-            visCount = m_minVisible;
+        return texture;
+    }
 
-        return static_cast<uint32_t>(visCount);
+    void ListBox::InvalidateViewport()
+    {
+        // the next render redraws every visible item instead of shifting the previous ones
+        m_viewportValid = false;
+        Invalidate();
+    }
+
+    bool ListBox::IsOpaqueImpl() const
+    {
+        return true;
     }
 
     void ListBox::OnHiddenChanged(bool isHidden)
@@ -173,6 +198,11 @@ namespace libsdlgui
             detail::NotificationMouseWheel(&m_vertScrollbar, wheelEvent);
     }
 
+    void ListBox::OnRenderTargetsReset()
+    {
+        InvalidateViewport();
+    }
+
     void ListBox::OnResize(int deltaH, int)
     {
         // keep the height of the scroll bar in sync with the height of the list box
@@ -181,42 +211,116 @@ namespace libsdlgui
         m_vertScrollbar.SetLocation(loc);
     }
 
-    void ListBox::OnZOrderChanged()
+    void ListBox::RenderImpl()
     {
-        // our z-order changed, keep the vertical scrollbar just above us
-        detail::SetZOrder(&m_vertScrollbar, detail::GetZOrder(this) + 1);
+        auto myLoc = GetLocation();
+
+        // without render targets the items are drawn straight to the window
+        if (!detail::RenderTargetsSupported(GetWindow()))
+        {
+            RenderItems(myLoc);
+            return;
+        }
+
+        // the visible items are kept in a texture, the second one is for shifting them
+        if (m_viewport.GetWidth() != myLoc.w || m_viewport.GetHeight() != myLoc.h)
+        {
+            m_viewport = detail::AcquireRenderTarget(GetWindow(), myLoc.w, myLoc.h);
+            m_scratch = detail::AcquireRenderTarget(GetWindow(), myLoc.w, myLoc.h);
+            m_viewportValid = false;
+        }
+
+        auto delta = static_cast<int64_t>(m_scrollOffset) - static_cast<int64_t>(m_viewportOffset);
+        if (!m_viewportValid || std::abs(delta) >= myLoc.h)
+        {
+            detail::RenderTargetHolder targetHolder(GetWindow(), m_viewport, SDLPoint(myLoc.x, myLoc.y));
+            RenderItems(myLoc);
+        }
+        else if (delta != 0)
+        {
+            // the items that are still visible are moved by the scroll delta with a single copy
+            // then only the exposed rows are drawn.  a texture can't be copied onto itself so
+            // the shifted pixels go into the scratch texture, which becomes the viewport.
+            auto shift = static_cast<int>(delta);
+            auto kept = myLoc.h - std::abs(shift);
+            auto source = SDLRect(0, std::max(shift, 0), myLoc.w, kept);
+            auto destination = SDLRect(myLoc.x, myLoc.y + std::max(-shift, 0), myLoc.w, kept);
+            auto exposed = shift > 0 ? SDLRect(myLoc.x, myLoc.y + kept, myLoc.w, shift) : SDLRect(myLoc.x, myLoc.y, myLoc.w, -shift);
+
+            {
+                detail::RenderTargetHolder targetHolder(GetWindow(), m_scratch, SDLPoint(myLoc.x, myLoc.y));
+                GetWindow()->DrawTexture(destination, m_viewport, &source);
+                RenderItems(exposed);
+            }
+
+            std::swap(m_viewport, m_scratch);
+        }
+
+        m_viewportOffset = m_scrollOffset;
+        m_viewportValid = true;
+        GetWindow()->DrawTexture(myLoc, m_viewport, nullptr);
     }
 
-    void ListBox::RenderImpl()
+    void ListBox::RenderItems(const SDL_Rect& area)
     {
-        auto itemLoc = GetLocation();
-        auto visCount = GetVisCount();
+        auto myLoc = GetLocation();
 
         // fill the background so nothing leaks through on lines
         // where the item texture doesn't fill the width of the control.
-        GetWindow()->DrawRectangle(itemLoc, GetBackgroundColor(), UINT8_MAX);
+        GetWindow()->DrawRectangle(area, GetBackgroundColor(), UINT8_MAX);
 
-        for (size_t i = m_visStart; i < m_visStart + visCount; ++i)
-        {
-            SDLTexture const* t;
-
-            if (std::get<2>(m_textures[i]) == false)
-                t = &std::get<0>(m_textures[i]);
-            else
-                t = &std::get<1>(m_textures[i]);
+        // start with the item at the top of the area, which can be partly scrolled out of
+        // view.  rows that overhang the area are drawn in full and clipped to the control.
+        auto first = (static_cast<uint32_t>(area.y - myLoc.y) + m_scrollOffset) / m_itemHeight;
+        auto itemLoc = myLoc;
+        itemLoc.y += static_cast<int>(first * m_itemHeight) - static_cast<int>(m_scrollOffset);
+        itemLoc.h = m_itemHeight;
 
-            itemLoc.h = t->GetHeight();
+        for (size_t i = first; i < m_textures.size() && itemLoc.y < area.y + area.h; ++i)
+        {
+            bool highlighted = std::get<2>(m_textures[i]);
+            auto& t = GetItemTexture(i, highlighted);
 
             // extend the highlighted appearance to the end of the control
-            if (std::get<2>(m_textures[i]))
-                GetWindow()->DrawRectangle(SDLRect(itemLoc.x, itemLoc.y, itemLoc.w, itemLoc.h), GetForegroundColor(), UINT8_MAX);
+            if (highlighted)
+                GetWindow()->DrawRectangle(itemLoc, GetForegroundColor(), UINT8_MAX);
 
-            GetWindow()->DrawText(itemLoc, *t, TextAlignment::MiddleLeft);
+            if (t != nullptr)
+                GetWindow()->DrawText(itemLoc, t, TextAlignment::MiddleLeft);
 
             itemLoc.y += m_itemHeight;
         }
     }
 
+    void ListBox::PrefetchItems(detail::ScrollDirection direction)
+    {
+        // rasterize the page of items beyond the visible ones on the task pool so scrolling onto them
+        // only has to upload their text.  a page is requested once until another one is.
+        auto pageItems = static_cast<uint32_t>(GetLocation().h) / m_itemHeight + 1;
+        auto firstVisible = m_scrollOffset / m_itemHeight;
+        uint32_t first = 0;
+        if (direction == detail::ScrollDirection::Increment)
+            first = firstVisible + pageItems;
+        else if (firstVisible > pageItems)
+            first = firstVisible - pageItems;
+
+        if (first == m_prefetchFirst || first >= m_items.size())
+            return;
+
+        m_prefetchFirst = first;
+        auto last = std::min<size_t>(first + pageItems, m_items.size());
+
+        std::vector<std::string> texts;
+        for (auto i = static_cast<size_t>(first); i < last; ++i)
+        {
+            if (std::get<0>(m_textures[i]) == nullptr)
+                texts.push_back(m_items[i]);
+        }
+
+        if (!texts.empty())
+            detail::RasterCache::GetInstance()->Prefetch(detail::GetFont(GetWindow()), std::move(texts), GetForegroundColor(), GetBackgroundColor());
+    }
+
     void ListBox::RegisterForSelectionChangedCallback(const SelectionChangedCallback& callback)
     {
         m_callback = callback;
@@ -224,11 +328,20 @@ namespace libsdlgui
 
     void ListBox::SelectedItemChanged()
     {
-        // move the vis start item within bounds
-        if (m_selected <= m_items.size() - m_maxVisible)
+        // scroll just far enough to bring the selected item fully into view
+        auto top = m_selected * m_itemHeight;
+        auto viewHeight = static_cast<uint32_t>(GetLocation().h);
+        auto offset = m_scrollOffset;
+        if (top < offset)
+            offset = top;
+        else if (top + m_itemHeight > offset + viewHeight)
+            offset = std::min(top + m_itemHeight - viewHeight, m_vertScrollbar.Maximum());
+
+        if (offset != m_scrollOffset)
         {
-            m_visStart = m_selected;
-            m_vertScrollbar.SetCurrent(m_visStart);
+            m_scrollOffset = offset;
+            m_vertScrollbar.SetCurrent(m_scrollOffset);
+            Invalidate();
         }
 
         SetHighlighted(m_selected);
@@ -237,6 +350,41 @@ namespace libsdlgui
             m_callback(m_items[m_selected]);
     }
 
+    void ListBox::SortItems(const ItemComparer& comparer)
+    {
+        // sort the positions of the items so their textures and the selection move with them
+        std::vector<uint32_t> order(m_items.size());
+        std::iota(order.begin(), order.end(), 0);
+        TaskPool::GetInstance()->Sort(order.begin(), order.end(), [this, &comparer](uint32_t lhs, uint32_t rhs)
+            {
+                return comparer(m_items[lhs], m_items[rhs]);
+            });
+
+        std::vector<std::string> items;
+        std::vector<std::tuple<SDLTexture, SDLTexture, bool>> textures;
+        items.reserve(m_items.size());
+        textures.reserve(m_textures.size());
+        auto selected = UINT32_MAX;
+        auto highlighted = UINT32_MAX;
+
+        for (uint32_t i = 0; i < order.size(); ++i)
+        {
+            items.push_back(std::move(m_items[order[i]]));
+            textures.push_back(std::move(m_textures[order[i]]));
+            if (order[i] == m_selected)
+                selected = i;
+            if (order[i] == m_highlighted)
+                highlighted = i;
+        }
+
+        m_items.swap(items);
+        m_textures.swap(textures);
+        m_selected = selected;
+        m_highlighted = highlighted;
+        m_prefetchFirst = UINT32_MAX;
+        InvalidateViewport();
+    }
+
     void ListBox::SetHighlighted(uint32_t index)
     {
         // unhighlight the current selection then highlight the new one
@@ -245,6 +393,7 @@ namespace libsdlgui
 
         m_highlighted = index;
         std::get<2>(m_textures[m_highlighted]) = true;
+        InvalidateViewport();
     }
 
 } // namespace libsdlgui
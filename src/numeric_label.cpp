@@ -0,0 +1,156 @@
+#include "stdafx.h"
+#include "glyph_atlas.hpp"
+#include "numeric_label.hpp"
+#include "window.hpp"
+
+namespace libsdlgui
+{
+    NumericLabel::NumericLabel(Window* pWindow, const SDL_Rect& location) :
+        Control(pWindow, location), m_length(0), m_pAtlas(nullptr), m_alignment(TextAlignment::MiddleRight)
+    {
+        SetEventInterest(EventInterest::None);
+
+        // default font is inherited from the window
+        m_pFont = detail::GetFont(pWindow);
+        assert(m_pFont != nullptr);
+        SetValue(0);
+    }
+
+    bool NumericLabel::IsOpaqueImpl() const
+    {
+        return true;
+    }
+
+    void NumericLabel::RenderImpl()
+    {
+        auto window = GetWindow();
+        auto location = GetLocation();
+        window->DrawRectangle(location, GetBackgroundColor(), UINT8_MAX);
+
+        // the atlas and suffix depend on the colors, which can change at any time
+        if (m_pAtlas == nullptr || !m_pAtlas->Matches(m_pFont, GetForegroundColor(), GetBackgroundColor()))
+        {
+            m_pAtlas = detail::GetGlyphAtlas(window, m_pFont, GetForegroundColor(), GetBackgroundColor());
+            m_suffixTexture = detail::CreateTextureForText(window, m_suffix, m_pFont, GetForegroundColor(), GetBackgroundColor());
+        }
+
+        auto first = m_buffer.data();
+        auto last = first + m_length;
+        auto width = m_pAtlas->Measure(first, last) + m_suffixTexture.GetWidth();
+        auto height = m_pAtlas->GetHeight();
+
+        // position the number and suffix as a single piece of text
+        auto x = location.x;
+        switch (m_alignment)
+        {
+        case TextAlignment::BottomCenter:
+        case TextAlignment::MiddleCenter:
+        case TextAlignment::TopCenter:
+            x += (location.w - width) / 2;
+            break;
+
+        case TextAlignment::BottomRight:
+        case TextAlignment::MiddleRight:
+        case TextAlignment::TopRight:
+            x += location.w - width;
+            break;
+        }
+
+        auto y = location.y;
+        switch (m_alignment)
+        {
+        case TextAlignment::BottomCenter:
+        case TextAlignment::BottomLeft:
+        case TextAlignment::BottomRight:
+            y += location.h - height;
+            break;
+
+        case TextAlignment::MiddleCenter:
+        case TextAlignment::MiddleLeft:
+        case TextAlignment::MiddleRight:
+            y += (location.h - height) / 2;
+            break;
+        }
+
+        for (auto c = first; c != last; ++c)
+        {
+            auto& glyph = m_pAtlas->GetGlyph(*c);
+            window->DrawTexture(SDLRect(x, y, glyph.w, glyph.h), m_pAtlas->GetTexture(), &glyph);
+            x += glyph.w;
+        }
+
+        if (m_suffixTexture.GetWidth() > 0)
+            window->DrawTexture(SDLRect(x, y, m_suffixTexture.GetWidth(), m_suffixTexture.GetHeight()), m_suffixTexture, nullptr);
+    }
+
+    void NumericLabel::SetAlignment(TextAlignment alignment)
+    {
+        if (alignment != m_alignment)
+        {
+            m_alignment = alignment;
+            Invalidate();
+        }
+    }
+
+    void NumericLabel::SetChars(const char* first, const char* last)
+    {
+        // an unchanged value doesn't invalidate the label
+        auto length = static_cast<size_t>(last - first);
+        if (length == m_length && std::equal(first, last, m_buffer.data()))
+            return;
+
+        std::copy(first, last, m_buffer.data());
+        m_length = length;
+        Invalidate();
+    }
+
+    void NumericLabel::SetFont(Font* pFont)
+    {
+        if (pFont != m_pFont)
+        {
+            m_pFont = pFont;
+            m_pAtlas = nullptr;
+            Invalidate();
+        }
+    }
+
+    void NumericLabel::SetSuffix(const std::string& suffix)
+    {
+        if (suffix != m_suffix)
+        {
+            m_suffix = suffix;
+            m_pAtlas = nullptr;
+            Invalidate();
+        }
+    }
+
+    void NumericLabel::SetValue(int64_t value)
+    {
+        std::array<char, 64> buffer;
+        auto result = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value);
+        assert(result.ec == std::errc());
+        SetChars(buffer.data(), result.ptr);
+    }
+
+    void NumericLabel::SetValue(double value, std::chars_format format, int precision)
+    {
+        assert(format != std::chars_format::hex || !"hexadecimal floats aren't supported");
+
+        std::array<char, 64> buffer;
+
+        // scientific notation needs the digits plus at most eight characters for the sign, the
+        // leading digit, the point and an exponent like e-308 so cap the precision to always fit
+        constexpr int maxPrecision = static_cast<int>(std::tuple_size_v<decltype(buffer)>) - 8;
+        precision = std::min(precision, maxPrecision);
+
+        auto result = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value, format, precision);
+
+        // very large values don't fit in fixed notation
+        if (result.ec != std::errc())
+            result = std::to_chars(buffer.data(), buffer.data() + buffer.size(), value, std::chars_format::scientific, precision);
+
+        assert(result.ec == std::errc());
+        SetChars(buffer.data(), result.ptr);
+    }
+
+} // namespace libsdlgui
@@ -0,0 +1,165 @@
+#include "stdafx.h"
+#include "exceptions.hpp"
+#include "glyph_atlas.hpp"
+#include "helpers.hpp"
+#include "raster_cache.hpp"
+#include "task_pool.hpp"
+#include "trace_events.hpp"
+
+namespace libsdlgui::detail
+{
+    RasterCache::CountType RasterCache::s_count = 0;
+    RasterCache::UnderlyingType RasterCache::s_instance = nullptr;
+
+    RasterCacheType::RasterCacheType() : m_textBytes(0)
+    {
+        // empty
+    }
+
+    RasterCacheType::~RasterCacheType()
+    {
+        // empty
+    }
+
+    std::shared_ptr<GlyphRaster> RasterCacheType::GetGlyphs(Font const* font, const SDL_Color& fgColor, const SDL_Color& bgColor)
+    {
+        auto key = ColorsKey(font, PackColor(fgColor), PackColor(bgColor));
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            auto iter = m_glyphs.find(key);
+            if (iter != m_glyphs.end())
+                return iter->second;
+        }
+
+        TraceSpan span("RasterCache::GetGlyphs", "raster");
+
+        // rasterize each character on its own so its cell is exactly its advance
+        std::vector<SDLSurface> surfaces;
+        surfaces.reserve(strlen(GlyphAtlas::Characters));
+        std::array<SDL_Rect, 128> glyphs;
+        glyphs.fill(SDLRect(0, 0, 0, 0));
+        int width = 0;
+        int height = 0;
+
+        for (auto c = GlyphAtlas::Characters; *c != '\0'; ++c)
+        {
+            char text[2] = { *c, '\0' };
+            surfaces.push_back(RenderShaded(font, text, fgColor, bgColor));
+
+            glyphs[static_cast<unsigned char>(*c)] = SDLRect(width, 0, surfaces.back()->w, surfaces.back()->h);
+            width += surfaces.back()->w;
+            height = std::max(height, surfaces.back()->h);
+        }
+
+        // lay the glyphs out in a single row
+        auto pAtlas = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, SDL_PIXELFORMAT_ARGB8888);
+        if (pAtlas == nullptr)
+            throw SDLException("SDL_CreateRGBSurfaceWithFormat failed with error '" + SDLGetError() + "'.");
+
+        auto raster = std::make_shared<GlyphRaster>(pAtlas, glyphs);
+
+        size_t index = 0;
+        for (auto c = GlyphAtlas::Characters; *c != '\0'; ++c, ++index)
+        {
+            auto cell = glyphs[static_cast<unsigned char>(*c)];
+            SDL_BlitSurface(surfaces[index], nullptr, raster->Surface, &cell);
+        }
+
+        // another thread might have rasterized the same glyphs meanwhile, the first one is kept
+        std::lock_guard<std::mutex> lock(m_lock);
+        return m_glyphs.emplace(key, raster).first->second;
+    }
+
+    std::shared_ptr<SDLSurface> RasterCacheType::GetText(Font const* font, const std::string& text, const SDL_Color& fgColor, const SDL_Color& bgColor)
+    {
+        assert(text.length() != 0);
+
+        auto key = TextKey(font, PackColor(fgColor), PackColor(bgColor), text);
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            auto iter = m_textIndex.find(key);
+            if (iter != m_textIndex.end())
+            {
+                // move the entry to the front as the most recently used
+                m_text.splice(m_text.begin(), m_text, iter->second);
+                return iter->second->second;
+            }
+        }
+
+        TraceSpan span("RasterCache::GetText", "raster");
+
+        // textures are filled from the surface so convert it to their format once
+        auto shaded = RenderShaded(font, text.c_str(), fgColor, bgColor);
+        auto surface = std::make_shared<SDLSurface>(SDL_ConvertSurfaceFormat(shaded, SDL_PIXELFORMAT_ARGB8888, 0));
+        if (*surface == nullptr)
+            throw SDLException("SDL_ConvertSurfaceFormat failed with error '" + SDLGetError() + "'.");
+
+        // blitting the surface copies it rather than blending
+        SDL_SetSurfaceBlendMode(*surface, SDL_BLENDMODE_NONE);
+
+        std::lock_guard<std::mutex> lock(m_lock);
+
+        // another thread might have rasterized the same text meanwhile, the first one is kept
+        auto iter = m_textIndex.find(key);
+        if (iter != m_textIndex.end())
+            return iter->second->second;
+
+        m_text.emplace_front(key, surface);
+        m_textIndex[key] = m_text.begin();
+        m_textBytes += static_cast<size_t>((*surface)->pitch) * (*surface)->h;
+
+        // evict the least recently used text, surfaces still in use are freed by their last user
+        while (m_textBytes > MaxTextBytes && m_text.size() > 1)
+        {
+            auto& oldest = m_text.back();
+            m_textBytes -= static_cast<size_t>((*oldest.second)->pitch) * (*oldest.second)->h;
+            m_textIndex.erase(oldest.first);
+            m_text.pop_back();
+        }
+
+        return surface;
+    }
+
+    void RasterCacheType::Prefetch(Font const* font, std::vector<std::string> texts, const SDL_Color& fgColor, const SDL_Color& bgColor)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            texts.erase(std::remove_if(texts.begin(), texts.end(), [&](const std::string& text)
+                {
+                    return text.empty() || m_textIndex.count(TextKey(font, PackColor(fgColor), PackColor(bgColor), text)) != 0;
+                }), texts.end());
+        }
+
+        // the pool is drained before the cache is destroyed so the tasks can refer to it
+        for (auto& text : texts)
+        {
+            TaskPool::GetInstance()->Post([this, font, text = std::move(text), fgColor, bgColor]()
+                {
+                    try
+                    {
+                        GetText(font, text, fgColor, bgColor);
+                    }
+                    catch (const SDLException&)
+                    {
+                        // the text is rasterized again when it's drawn, which reports the error
+                    }
+                });
+        }
+    }
+
+    SDLSurface RasterCacheType::RenderShaded(Font const* font, const char* text, const SDL_Color& fgColor, const SDL_Color& bgColor)
+    {
+        std::lock_guard<std::mutex> lock(font->GetLock());
+
+        auto currentStyle = static_cast<Font::Attributes>(TTF_GetFontStyle(font->GetTtf()));
+        if (currentStyle != font->GetAttributes())
+            TTF_SetFontStyle(font->GetTtf(), static_cast<int>(font->GetAttributes()));
+
+        SDLSurface surface(TTF_RenderText_Shaded(font->GetTtf(), text, fgColor, bgColor));
+        if (surface == nullptr)
+            throw SDLException("TTF_RenderText_Shaded failed with error '" + TTFGetError() + "'.");
+
+        return surface;
+    }
+
+} // namespace libsdlgui::detail
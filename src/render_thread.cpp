@@ -0,0 +1,127 @@
+#include "stdafx.h"
+#include "render_thread.hpp"
+#include "trace_events.hpp"
+
+namespace libsdlgui::detail
+{
+    RenderThread::RenderThread(SDL_Renderer* pRenderer, std::mutex& rendererLock) :
+        m_pRenderer(pRenderer), m_rendererLock(rendererLock), m_presentedFrame(0), m_busy(false), m_stopping(false)
+    {
+        m_thread = std::thread(&RenderThread::Run, this);
+    }
+
+    RenderThread::~RenderThread()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            m_stopping = true;
+        }
+
+        m_published.notify_one();
+        m_thread.join();
+    }
+
+    void RenderThread::Discard()
+    {
+        std::unique_lock<std::mutex> lock(m_lock);
+        if (m_pPublished != nullptr)
+        {
+            m_pPublished->Reset(0);
+            m_pSpare = std::move(m_pPublished);
+        }
+
+        m_idle.wait(lock, [this]() { return !m_busy; });
+    }
+
+    void RenderThread::Publish(DisplayList& recorded)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_lock);
+            if (m_pPublished != nullptr)
+            {
+                // the thread is still busy with an earlier frame, the window is drawn by the new one
+                // unless it only updates textures
+                if (recorded.DrawsWindow())
+                    m_pPublished->DropWindowDrawing();
+
+                m_pPublished->Append(recorded);
+                recorded.Reset(0);
+            }
+            else
+            {
+                m_pPublished = m_pSpare != nullptr ? std::move(m_pSpare) : std::make_unique<DisplayList>();
+                m_pPublished->Swap(recorded);
+            }
+        }
+
+        m_published.notify_one();
+    }
+
+    void RenderThread::Run()
+    {
+        while (true)
+        {
+            std::unique_ptr<DisplayList> pList;
+            {
+                std::unique_lock<std::mutex> lock(m_lock);
+                m_published.wait(lock, [this]() { return m_stopping || m_pPublished != nullptr; });
+                if (m_pPublished == nullptr)
+                    break;
+
+                pList = std::move(m_pPublished);
+                m_busy = true;
+            }
+
+            {
+                TraceSpan span("RenderThread::Present", "frame");
+
+                // the renderer isn't thread-safe so the UI thread can't create or destroy textures while
+                // it presents either.  a list that only updates textures leaves the window's content as it is.
+                std::lock_guard<std::mutex> rendererLock(m_rendererLock);
+                pList->Replay(m_pRenderer);
+                if (pList->DrawsWindow())
+                    SDL_RenderPresent(m_pRenderer);
+            }
+
+            // the frame is measured once it's on the display, a list that doesn't draw the window isn't a frame
+            auto presented = SDL_GetPerformanceCounter();
+            auto ticksPerMicrosecond = SDL_GetPerformanceFrequency() / 1000000.0;
+            auto& timing = pList->GetTiming();
+            m_presentedFrame = pList->GetFrame();
+
+            // keep the list's memory for the next frame
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (pList->DrawsWindow() && timing.Start != 0)
+                {
+                    m_frameTimes.push_back(static_cast<uint64_t>((presented - timing.Start) / ticksPerMicrosecond));
+                    if (timing.InputCounter != 0)
+                    {
+                        auto latency = static_cast<uint64_t>((presented - timing.InputCounter) / ticksPerMicrosecond);
+                        m_inputLatencies.push_back(latency + timing.InputDelay * 1000ull);
+                    }
+                }
+
+                pList->Reset(0);
+                m_pSpare = std::move(pList);
+                m_busy = false;
+            }
+
+            m_idle.notify_all();
+        }
+    }
+
+    void RenderThread::TakeMeasurements(LatencyHistogram& frameTimes, LatencyHistogram& inputLatency)
+    {
+        std::lock_guard<std::mutex> lock(m_lock);
+        for (auto frameTime : m_frameTimes)
+            frameTimes.Record(frameTime);
+
+        for (auto latency : m_inputLatencies)
+            inputLatency.Record(latency);
+
+        m_frameTimes.clear();
+        m_inputLatencies.clear();
+    }
+
+} // namespace libsdlgui::detail
@@ -1,6 +1,7 @@
 #include "stdafx.h"
 #include "exceptions.hpp"
 #include "sdl_helpers.hpp"
+#include "texture_pool.hpp"
 
 namespace libsdlgui
 {
@@ -109,12 +110,26 @@ namespace libsdlgui
             SDL_FreeSurface(m_pSurface);
     }
 
-    SDLTexture::SDLTexture(SDL_Texture* pTexture, int width, int height) : m_pTexture(pTexture), m_width(width), m_height(height)
+    SDLTexture::SDLTexture(SDL_Texture* pTexture, int width, int height) :
+        SDLTexture(pTexture, width, height, width, height)
+    {
+        // empty
+    }
+
+    SDLTexture::SDLTexture(SDL_Texture* pTexture, int width, int height, int capacityWidth, int capacityHeight) :
+        SDLTexture(pTexture, width, height, capacityWidth, capacityHeight, nullptr)
+    {
+        // empty
+    }
+
+    SDLTexture::SDLTexture(SDL_Texture* pTexture, int width, int height, int capacityWidth, int capacityHeight, detail::TexturePool* pPool) :
+        m_pTexture(pTexture), m_pPool(pPool), m_width(width), m_height(height), m_capacityWidth(capacityWidth), m_capacityHeight(capacityHeight)
     {
         assert(m_pTexture != nullptr);
+        assert(m_width <= m_capacityWidth && m_height <= m_capacityHeight);
     }
 
-    SDLTexture::SDLTexture(SDLTexture&& other) : m_pTexture(nullptr), m_width(0), m_height(0)
+    SDLTexture::SDLTexture(SDLTexture&& other) : m_pTexture(nullptr), m_pPool(nullptr), m_width(0), m_height(0), m_capacityWidth(0), m_capacityHeight(0)
     {
         *this = std::move(other);
     }
@@ -126,7 +141,12 @@ namespace libsdlgui
 
     void SDLTexture::Cleanup()
     {
-        if (m_pTexture != nullptr)
+        if (m_pTexture == nullptr)
+            return;
+
+        if (m_pPool != nullptr)
+            m_pPool->Release(m_pTexture);
+        else
             SDL_DestroyTexture(m_pTexture);
     }
 
@@ -136,11 +156,17 @@ namespace libsdlgui
         {
             Cleanup();
             m_pTexture = rhs.m_pTexture;
+            m_pPool = rhs.m_pPool;
             m_width = rhs.m_width;
             m_height = rhs.m_height;
+            m_capacityWidth = rhs.m_capacityWidth;
+            m_capacityHeight = rhs.m_capacityHeight;
             rhs.m_pTexture = nullptr;
+            rhs.m_pPool = nullptr;
             rhs.m_width = 0;
             rhs.m_height = 0;
+            rhs.m_capacityWidth = 0;
+            rhs.m_capacityHeight = 0;
         }
 
         return *this;
@@ -151,6 +177,13 @@ namespace libsdlgui
         return *this = rhs;
     }
 
+    void SDLTexture::SetSize(int width, int height)
+    {
+        assert(width <= m_capacityWidth && height <= m_capacityHeight);
+        m_width = width;
+        m_height = height;
+    }
+
     TTFFont::TTFFont(const std::filesystem::path& fileName, int size)
     {
         m_pFont = TTF_OpenFont(fileName.string().c_str(), size);
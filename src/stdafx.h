@@ -5,12 +5,20 @@
 #define WIN32_LEAN_AND_MEAN             // Exclude rarely-used stuff from Windows headers
 
 #include <algorithm>
+#include <array>
+#include <charconv>
 #include <atomic>
 #include <filesystem>
 #include <cassert>
 #include <cctype>
+#include <cmath>
+#include <condition_variable>
+#include <fstream>
 #include <functional>
+#include <iomanip>
 #include <memory>
+#include <mutex>
+#include <numeric>
 #include <SDL.h>
 #include <SDL_error.h>
 #include <SDL_events.h>
@@ -24,5 +32,8 @@
 #include <stdexcept>
 #include <stdint.h>
 #include <string>
+#include <thread>
+#include <typeinfo>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
@@ -0,0 +1,245 @@
+#include "stdafx.h"
+#include "task_pool.hpp"
+
+namespace libsdlgui
+{
+    TaskPool::CountType TaskPool::s_count = 0;
+    TaskPool::UnderlyingType TaskPool::s_instance = nullptr;
+
+    namespace detail
+    {
+        thread_local TaskPoolType::Worker* TaskPoolType::t_pWorker = nullptr;
+
+        TaskPoolType::TaskPoolType() : m_queued(0), m_nextVictim(0), m_stopping(false)
+        {
+            Start(0);
+        }
+
+        TaskPoolType::~TaskPoolType()
+        {
+            Stop();
+        }
+
+        void TaskPoolType::ParallelFor(size_t begin, size_t end, const RangeTask& body, size_t grain)
+        {
+            if (begin >= end)
+                return;
+
+            auto count = end - begin;
+            if (grain == 0)
+                grain = std::max<size_t>(1, count / ((m_workers.size() + 1) * 4));
+
+            auto ranges = (count + grain - 1) / grain;
+            if (ranges == 1)
+            {
+                body(begin, end);
+                return;
+            }
+
+            // the threads claim ranges until there are none left.  helpers that start after
+            // every range has been claimed return without touching the body.
+            struct State
+            {
+                RangeTask const* pBody;
+                std::atomic<size_t> Next;
+                std::atomic<size_t> Done;
+                std::mutex Lock;
+                std::exception_ptr Error;
+            };
+
+            auto pState = std::make_shared<State>();
+            pState->pBody = &body;
+            pState->Next = 0;
+            pState->Done = 0;
+
+            auto runRanges = [pState, begin, end, grain, ranges]()
+            {
+                for (auto range = pState->Next++; range < ranges; range = pState->Next++)
+                {
+                    auto first = begin + (range * grain);
+                    try
+                    {
+                        (*pState->pBody)(first, std::min(first + grain, end));
+                    }
+                    catch (...)
+                    {
+                        std::lock_guard<std::mutex> lock(pState->Lock);
+                        if (pState->Error == nullptr)
+                            pState->Error = std::current_exception();
+                    }
+
+                    ++pState->Done;
+                }
+            };
+
+            auto helpers = std::min(ranges - 1, m_workers.size());
+            for (size_t i = 0; i < helpers; ++i)
+                Post(runRanges);
+
+            runRanges();
+
+            // help with other tasks while the ranges claimed by workers finish
+            while (pState->Done < ranges)
+            {
+                if (!RunPendingTask())
+                    std::this_thread::yield();
+            }
+
+            if (pState->Error != nullptr)
+                std::rethrow_exception(pState->Error);
+        }
+
+        void TaskPoolType::Post(Task task)
+        {
+            assert(task != nullptr);
+
+            // counted first so the count never drops below the number of queued tasks
+            ++m_queued;
+            if (t_pWorker != nullptr)
+            {
+                std::lock_guard<std::mutex> lock(t_pWorker->Lock);
+                t_pWorker->Tasks.push_back(std::move(task));
+            }
+            else
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_shared.push_back(std::move(task));
+            }
+
+            WakeWorker();
+        }
+
+        bool TaskPoolType::RunPendingTask()
+        {
+            Task task;
+            if (!TakeTask(t_pWorker, task))
+                return false;
+
+            task();
+            return true;
+        }
+
+        void TaskPoolType::SetThreadCount(size_t threadCount)
+        {
+            assert(t_pWorker == nullptr);
+
+            Stop();
+            Start(threadCount);
+        }
+
+        void TaskPoolType::Start(size_t threadCount)
+        {
+            // the UI thread is busy too and takes part in ParallelFor()
+            if (threadCount == 0)
+                threadCount = std::max(1u, std::thread::hardware_concurrency()) - 1;
+
+            m_stopping = false;
+            m_workers.reserve(std::max<size_t>(1, threadCount));
+            for (size_t i = 0; i < std::max<size_t>(1, threadCount); ++i)
+                m_workers.push_back(std::make_unique<Worker>());
+
+            // the workers are started once the vector won't change as they steal from each other
+            for (auto& pWorker : m_workers)
+                pWorker->Thread = std::thread(&TaskPoolType::WorkerLoop, this, pWorker.get());
+        }
+
+        void TaskPoolType::Stop()
+        {
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                m_stopping = true;
+            }
+
+            m_wake.notify_all();
+            for (auto& pWorker : m_workers)
+                pWorker->Thread.join();
+
+            m_workers.clear();
+        }
+
+        bool TaskPoolType::TakeTask(Worker* pWorker, Task& task)
+        {
+            if (m_queued == 0)
+                return false;
+
+            // the newest task of our own is the most likely to have its data in the cache
+            if (pWorker != nullptr)
+            {
+                std::lock_guard<std::mutex> lock(pWorker->Lock);
+                if (!pWorker->Tasks.empty())
+                {
+                    task = std::move(pWorker->Tasks.back());
+                    pWorker->Tasks.pop_back();
+                    --m_queued;
+                    return true;
+                }
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+                if (!m_shared.empty())
+                {
+                    task = std::move(m_shared.front());
+                    m_shared.pop_front();
+                    --m_queued;
+                    return true;
+                }
+            }
+
+            // steal the oldest task of another worker, starting with a different victim each time
+            auto start = m_nextVictim++;
+            for (size_t i = 0; i < m_workers.size(); ++i)
+            {
+                auto pVictim = m_workers[(start + i) % m_workers.size()].get();
+                if (pVictim == pWorker)
+                    continue;
+
+                std::lock_guard<std::mutex> lock(pVictim->Lock);
+                if (!pVictim->Tasks.empty())
+                {
+                    task = std::move(pVictim->Tasks.front());
+                    pVictim->Tasks.pop_front();
+                    --m_queued;
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        void TaskPoolType::WakeWorker()
+        {
+            // taking the lock orders the new count before a worker that's about to wait checks it
+            {
+                std::lock_guard<std::mutex> lock(m_lock);
+            }
+
+            m_wake.notify_one();
+        }
+
+        void TaskPoolType::WorkerLoop(Worker* pWorker)
+        {
+            t_pWorker = pWorker;
+
+            Task task;
+            while (true)
+            {
+                if (TakeTask(pWorker, task))
+                {
+                    task();
+                    task = nullptr;
+                    continue;
+                }
+
+                // the queued tasks are run before stopping
+                std::unique_lock<std::mutex> lock(m_lock);
+                m_wake.wait(lock, [this]() { return m_stopping || m_queued != 0; });
+                if (m_stopping && m_queued == 0)
+                    break;
+            }
+
+            t_pWorker = nullptr;
+        }
+    }
+
+} // namespace libsdlgui
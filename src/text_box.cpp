@@ -7,16 +7,20 @@ namespace libsdlgui
 {
     TextBox::TextBox(Window* pWindow, const SDL_Rect& location) :
         Control(pWindow, location),
-        m_caret(pWindow, SDLRect(location.x + TextOffsetX, location.y + 8, CaretWidth, location.h - 16)),
+        m_caret(pWindow, SDLRect(location.x + TextOffsetX, location.y + 8, CaretWidth, location.h - 16), this),
         m_pPrevCursor(nullptr),
         m_position(0),
         m_clipOffset(0)
     {
+        // hovering changes the cursor to an I-beam
+        SetEventInterest(EventInterest::Hover | EventInterest::Keyboard | EventInterest::TextInput);
         SetBorderColor(SDLColor(128, 128, 128, 0));
         SetBorderSize(1);
+    }
 
-        // place the caret above the text box
-        detail::SetZOrder(&m_caret, detail::GetZOrder(this) + 1);
+    bool TextBox::IsOpaqueImpl() const
+    {
+        return true;
     }
 
     void TextBox::KeydownBackspace()
@@ -33,6 +37,7 @@ namespace libsdlgui
             m_text.erase(m_position - 1, 1);
 
         m_texture = detail::CreateTextureForText(GetWindow(), m_text, detail::GetFont(GetWindow()), GetForegroundColor(), GetBackgroundColor());
+        Invalidate();
         --m_position;
 
         // don't move the caret if the string is bigger than the text box
@@ -62,6 +67,7 @@ namespace libsdlgui
         {
             m_text.erase(m_position, 1);
             m_texture = detail::CreateTextureForText(GetWindow(), m_text, detail::GetFont(GetWindow()), GetForegroundColor(), GetBackgroundColor());
+            Invalidate();
         }
     }
 
@@ -120,6 +126,9 @@ namespace libsdlgui
 
         assert(m_clipOffset >= 0);
         m_caret.SetLocation(caretLoc);
+
+        // the visible portion of the text might have scrolled
+        Invalidate();
     }
 
     void TextBox::OnFocusAcquired()
@@ -286,12 +295,7 @@ namespace libsdlgui
 
         ++m_position;
         m_texture = detail::CreateTextureForText(GetWindow(), m_text, detail::GetFont(GetWindow()), GetForegroundColor(), GetBackgroundColor());
-    }
-
-    void TextBox::OnZOrderChanged()
-    {
-        // our z-order changed, keep the caret above us
-        detail::SetZOrder(&m_caret, detail::GetZOrder(this) + 1);
+        Invalidate();
     }
 
     void TextBox::RenderImpl()
@@ -317,14 +321,13 @@ namespace libsdlgui
         clip.x = m_clipOffset;
         clip.y = 0;
         clip.h = location.h;
-        clip.w = GetLocation().w - (TextOffsetX * 2);
+        clip.w = std::min(GetLocation().w - (TextOffsetX * 2), m_texture.GetWidth() - m_clipOffset);
 
         // if the portion of the texture being displayed doesn't completely fill
-        // the location's width decrease the width so the texture isn't stretched
+        // the location's width decrease the width so the texture isn't stretched.
+        // pooled textures can be wider than the text so never copy past it.
 
-        auto deltaWidth = (clip.w - (m_texture.GetWidth() - m_clipOffset));
-        if (deltaWidth > 0)
-            location.w -= deltaWidth;
+        location.w = std::min(location.w, clip.w);
 
         GetWindow()->DrawRectangle(GetLocation(), GetBackgroundColor(), UINT8_MAX);
         GetWindow()->DrawTexture(location, m_texture, &clip);
@@ -0,0 +1,189 @@
+#include "stdafx.h"
+#include "exceptions.hpp"
+#include "texture_pool.hpp"
+#include "trace_events.hpp"
+
+namespace libsdlgui::detail
+{
+    TexturePool::TexturePool() : m_pRenderer(nullptr), m_maxPooledBytes(0), m_frame(0), m_deferRelease(false)
+    {
+        // empty
+    }
+
+    TexturePool::~TexturePool()
+    {
+        Clear();
+    }
+
+    SDLTexture TexturePool::Acquire(uint32_t format, int access, int width, int height)
+    {
+        assert(m_pRenderer != nullptr);
+        assert(width > 0 && height > 0);
+
+        auto capacityWidth = GetSizeClass(width);
+        auto capacityHeight = GetSizeClass(height);
+
+        auto iter = m_free.find(Bucket(format, access, capacityWidth, capacityHeight));
+        if (iter != m_free.end() && !iter->second.empty())
+        {
+            auto pTexture = iter->second.back();
+            iter->second.pop_back();
+
+            --m_stats.PooledTextures;
+            m_stats.PooledBytes -= GetTextureBytes(format, capacityWidth, capacityHeight);
+            ++m_stats.Reused;
+
+            return SDLTexture(pTexture, width, height, capacityWidth, capacityHeight, this);
+        }
+
+        TraceSpan span("TexturePool::Acquire", "raster");
+
+        SDL_Texture* pTexture = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(m_rendererLock);
+            pTexture = SDL_CreateTexture(m_pRenderer, format, access, capacityWidth, capacityHeight);
+        }
+
+        if (pTexture == nullptr)
+            throw SDLException("SDL_CreateTexture failed with error '" + SDLGetError() + "'.");
+
+        ++m_stats.Created;
+        return SDLTexture(pTexture, width, height, capacityWidth, capacityHeight, this);
+    }
+
+    void TexturePool::Clear()
+    {
+        for (auto& retired : m_retired)
+            Destroy(retired.second);
+
+        m_retired.clear();
+        DestroyUntil(0);
+        m_free.clear();
+    }
+
+    void TexturePool::Destroy(SDL_Texture* pTexture)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_rendererLock);
+            SDL_DestroyTexture(pTexture);
+        }
+
+        ++m_stats.Destroyed;
+    }
+
+    void TexturePool::DestroyUntil(size_t maxBytes)
+    {
+        for (auto& bucket : m_free)
+        {
+            auto& textures = bucket.second;
+            auto bytes = GetTextureBytes(std::get<0>(bucket.first), std::get<2>(bucket.first), std::get<3>(bucket.first));
+
+            // the oldest textures are at the front of each bucket
+            size_t count = 0;
+            while (count < textures.size() && m_stats.PooledBytes > maxBytes)
+            {
+                Destroy(textures[count++]);
+                --m_stats.PooledTextures;
+                m_stats.PooledBytes -= bytes;
+            }
+
+            textures.erase(textures.begin(), textures.begin() + count);
+            if (m_stats.PooledBytes <= maxBytes)
+                break;
+        }
+    }
+
+    int TexturePool::GetSizeClass(int size)
+    {
+        const int MinSize = 16;
+        if (size <= MinSize)
+            return MinSize;
+
+        // round up to a quarter of the power of two below the size so at most a quarter is wasted
+        int power = MinSize;
+        while (power * 2 < size)
+            power *= 2;
+
+        auto step = power / 4;
+        return ((size + step - 1) / step) * step;
+    }
+
+    size_t TexturePool::GetTextureBytes(uint32_t format, int width, int height)
+    {
+        return static_cast<size_t>(width) * static_cast<size_t>(height) * SDL_BYTESPERPIXEL(format);
+    }
+
+    void TexturePool::Reclaim(uint64_t presentedFrame)
+    {
+        if (m_retired.empty())
+            return;
+
+        // textures are retired in frame order
+        auto iter = m_retired.begin();
+        for (; iter != m_retired.end() && iter->first <= presentedFrame; ++iter)
+            Recycle(iter->second);
+
+        m_retired.erase(m_retired.begin(), iter);
+    }
+
+    void TexturePool::Recycle(SDL_Texture* pTexture)
+    {
+        uint32_t format = 0;
+        int access = 0;
+        int width = 0;
+        int height = 0;
+        SDL_QueryTexture(pTexture, &format, &access, &width, &height);
+
+        auto bytes = GetTextureBytes(format, width, height);
+        if (bytes > m_maxPooledBytes || m_pRenderer == nullptr)
+        {
+            Destroy(pTexture);
+            return;
+        }
+
+        // make room by destroying other pooled textures
+        if (m_stats.PooledBytes + bytes > m_maxPooledBytes)
+            DestroyUntil(m_maxPooledBytes - bytes);
+
+        // textures drawn with blending must not pass that on to their next owner
+        SDL_SetTextureBlendMode(pTexture, SDL_BLENDMODE_NONE);
+
+        m_free[Bucket(format, access, width, height)].push_back(pTexture);
+        ++m_stats.PooledTextures;
+        m_stats.PooledBytes += bytes;
+    }
+
+    void TexturePool::Release(SDL_Texture* pTexture)
+    {
+        assert(pTexture != nullptr);
+
+        // the frames that are still to be presented might draw the texture
+        if (m_deferRelease && m_pRenderer != nullptr)
+        {
+            m_retired.emplace_back(m_frame, pTexture);
+            return;
+        }
+
+        Recycle(pTexture);
+    }
+
+    void TexturePool::SetMaxPooledBytes(size_t maxBytes)
+    {
+        m_maxPooledBytes = maxBytes;
+        DestroyUntil(m_maxPooledBytes);
+    }
+
+    void TexturePool::SetRenderer(SDL_Renderer* pRenderer)
+    {
+        if (m_pRenderer != pRenderer)
+            Clear();
+
+        m_pRenderer = pRenderer;
+    }
+
+    void TexturePool::Trim(size_t maxBytes)
+    {
+        DestroyUntil(maxBytes);
+    }
+
+} // namespace libsdlgui::detail
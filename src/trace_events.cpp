@@ -0,0 +1,135 @@
+#include "stdafx.h"
+#include "trace_events.hpp"
+
+namespace libsdlgui
+{
+    namespace detail
+    {
+        std::atomic<bool> g_traceEnabled(false);
+
+        namespace
+        {
+            // number of spans kept per thread, older spans are overwritten
+            const size_t TraceBufferCapacity = 16384;
+
+            struct TraceRecord
+            {
+                const char* Name;
+                const char* Category;
+                uint64_t Start;
+                uint64_t End;
+            };
+
+            // ring buffer of spans recorded by a single thread.  the lock is
+            // only contended while the buffer is being flushed.
+            struct TraceBuffer
+            {
+                std::mutex Lock;
+                std::vector<TraceRecord> Records;
+                size_t Next;
+                size_t Count;
+                uint32_t ThreadId;
+
+                TraceBuffer(uint32_t threadId) : Next(0), Count(0), ThreadId(threadId)
+                {
+                    Records.resize(TraceBufferCapacity);
+                }
+            };
+
+            std::mutex g_buffersLock;
+            std::vector<std::shared_ptr<TraceBuffer>> g_buffers;
+
+            TraceBuffer* GetThreadBuffer()
+            {
+                thread_local std::shared_ptr<TraceBuffer> buffer;
+                if (buffer == nullptr)
+                {
+                    std::lock_guard<std::mutex> lock(g_buffersLock);
+                    buffer = std::make_shared<TraceBuffer>(static_cast<uint32_t>(g_buffers.size() + 1));
+                    g_buffers.push_back(buffer);
+                }
+
+                return buffer.get();
+            }
+
+            void WriteJsonString(std::ostream& stream, const char* value)
+            {
+                stream << '"';
+                for (auto c = value; *c != '\0'; ++c)
+                {
+                    if (*c == '"' || *c == '\\')
+                        stream << '\\';
+
+                    stream << *c;
+                }
+                stream << '"';
+            }
+        }
+
+        uint64_t GetTraceTimestamp()
+        {
+            return SDL_GetPerformanceCounter();
+        }
+
+        void RecordTraceSpan(const char* name, const char* category, uint64_t start, uint64_t end)
+        {
+            auto buffer = GetThreadBuffer();
+            std::lock_guard<std::mutex> lock(buffer->Lock);
+
+            buffer->Records[buffer->Next] = { name, category, start, end };
+            buffer->Next = (buffer->Next + 1) % TraceBufferCapacity;
+            if (buffer->Count < TraceBufferCapacity)
+                ++buffer->Count;
+        }
+    }
+
+    void FlushTraceEvents(const std::filesystem::path& fileName)
+    {
+        std::ofstream stream(fileName, std::ios::out | std::ios::trunc);
+        if (!stream)
+            throw std::runtime_error("failed to open trace file '" + fileName.string() + "'");
+
+        // trace_event timestamps are in microseconds
+        auto ticksPerMicrosecond = static_cast<double>(SDL_GetPerformanceFrequency()) / 1000000.0;
+
+        stream << "{\"traceEvents\":[";
+        bool first = true;
+
+        std::lock_guard<std::mutex> lock(detail::g_buffersLock);
+        for (auto& buffer : detail::g_buffers)
+        {
+            std::lock_guard<std::mutex> bufferLock(buffer->Lock);
+
+            // oldest record first
+            auto index = (buffer->Next + detail::TraceBufferCapacity - buffer->Count) % detail::TraceBufferCapacity;
+            for (size_t i = 0; i < buffer->Count; ++i)
+            {
+                auto& record = buffer->Records[index];
+                index = (index + 1) % detail::TraceBufferCapacity;
+
+                if (!first)
+                    stream << ',';
+                first = false;
+
+                stream << "\n{\"name\":";
+                detail::WriteJsonString(stream, record.Name);
+                stream << ",\"cat\":";
+                detail::WriteJsonString(stream, record.Category);
+                stream << ",\"ph\":\"X\",\"ts\":" << std::fixed << std::setprecision(3) << (record.Start / ticksPerMicrosecond)
+                    << ",\"dur\":" << ((record.End - record.Start) / ticksPerMicrosecond)
+                    << ",\"pid\":1,\"tid\":" << buffer->ThreadId << '}';
+            }
+
+            buffer->Next = 0;
+            buffer->Count = 0;
+        }
+
+        stream << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    }
+
+    void SetTraceEnabled(bool enabled)
+    {
+        detail::g_traceEnabled.store(enabled, std::memory_order_relaxed);
+    }
+
+} // namespace libsdlgui
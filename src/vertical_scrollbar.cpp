@@ -5,6 +5,18 @@
 
 namespace libsdlgui::detail
 {
+    namespace
+    {
+        // seconds for the speed of a glide to decay to about a third
+        const double GlideTimeConstant = 0.125;
+
+        // a glide slower than this many pixels per second stops
+        const double GlideStopVelocity = 8.0;
+
+        // milliseconds between glide steps, roughly a frame at 60 fps
+        const uint32_t GlideInterval = 16;
+    }
+
     VerticalScrollbar::VerticalScrollbar(Window* pWindow, const SDL_Rect& location, Control* parent) :
         Control(pWindow, location, parent),
         m_current(0),
@@ -12,11 +24,18 @@ namespace libsdlgui::detail
         m_min(0),
         m_largeChange(10),
         m_smallChange(1),
+        m_pageSize(0),
+        m_dragOffset(0),
+        m_glidePosition(0),
+        m_glideVelocity(0),
+        m_glideTicks(0),
         m_held(ButtonClicked::None),
         m_showSlider(false),
-        m_dragSlider(false)
+        m_dragSlider(false),
+        m_gliding(false)
     {
         m_sliderLoc = { 0, 0, 0, 0 };
+        SetEventInterest(EventInterest::Hover | EventInterest::MouseMotion | EventInterest::MouseWheel);
     }
 
     SDL_Rect VerticalScrollbar::GetButtonBounds(bool isUp) const
@@ -70,27 +89,89 @@ namespace libsdlgui::detail
         return dir;
     }
 
-    void VerticalScrollbar::MoveSlider()
+    void VerticalScrollbar::Glide()
     {
-        if (m_showSlider)
+        auto ticks = GetWindow()->GetTicks();
+        auto elapsed = (ticks - m_glideTicks) / 1000.0;
+        m_glideTicks = ticks;
+
+        // the speed decays exponentially so integrate it over the elapsed time, this
+        // keeps the distance travelled the same regardless of the frame rate.
+        auto decay = std::exp(-elapsed / GlideTimeConstant);
+        m_glidePosition += m_glideVelocity * GlideTimeConstant * (1.0 - decay);
+        m_glideVelocity *= decay;
+
+        // stop at either end of the range
+        if (m_glidePosition <= m_min || m_glidePosition >= m_max)
         {
-            // get the height of the slider
-            auto height = m_sliderLoc.h;
+            m_glidePosition = std::clamp(m_glidePosition, static_cast<double>(m_min), static_cast<double>(m_max));
+            m_glideVelocity = 0;
+        }
 
-            // get the full range of pixels available for sliding
-            auto downButton = GetButtonBounds(false);
+        ScrollTo(static_cast<uint32_t>(std::lround(m_glidePosition)), ScrollMagnitude::Small);
+
+        if (std::abs(m_glideVelocity) < GlideStopVelocity)
+            StopGliding();
+    }
+
+    bool VerticalScrollbar::IsOpaqueImpl() const
+    {
+        return true;
+    }
+
+    void VerticalScrollbar::LayoutSlider()
+    {
+        // check the size of the control, if it's too
+        // small then don't display the slider
+
+        auto myLoc = GetLocation();
+        auto downButton = GetButtonBounds(false);
+
+        m_showSlider = myLoc.h > (downButton.h * 3);
+
+        if (m_showSlider)
+        {
             auto upButton = GetButtonBounds(true);
-            auto range = downButton.y - (upButton.y + upButton.h) - height;
+
+            // get the range of pixels available
+            auto range = downButton.y - (upButton.y + upButton.h);
+            auto span = m_max - m_min;
+
+            // the slider is to the track what the page is to the whole range.
+            // without a page size the slider shrinks as the range grows.
+            int height = 0;
+            if (m_pageSize != 0)
+                height = static_cast<int>((static_cast<uint64_t>(range) * m_pageSize) / (static_cast<uint64_t>(span) + m_pageSize));
+            else
+                height = range - static_cast<int>(span);
+
+            // don't let the slider get any smaller than a half button
+            if (height < downButton.h / 2)
+                height = downButton.h / 2;
+
+            m_sliderLoc = myLoc;
+            m_sliderLoc.y = upButton.y + upButton.h;
+            m_sliderLoc.h = height;
 
             // normalize the min/max range to the range of available pixels
 
             // y = Min + (x - A) * (Max - Min) / (B - A)
-            m_sliderLoc.y = (upButton.y + upButton.h) + (m_current - m_min) * (range) / (m_max - m_min);
+            auto travel = range - height;
+            if (span != 0 && travel > 0)
+                m_sliderLoc.y += static_cast<int>((static_cast<uint64_t>(m_current - m_min) * travel) / span);
         }
+
+        Invalidate();
     }
 
     void VerticalScrollbar::OnElapsedTime()
     {
+        if (m_gliding)
+        {
+            Glide();
+            return;
+        }
+
         bool accelerate = false;
 
         if ((static_cast<uint8_t>(m_held) & 0x80) == 0x80)
@@ -113,6 +194,9 @@ namespace libsdlgui::detail
             ButtonClicked buttonClicked = GetButtonClicked(SDLPoint(buttonEvent.x, buttonEvent.y));
             if (buttonClicked != ButtonClicked::None)
             {
+                // taking hold of the scroll bar stops it gliding
+                StopGliding();
+
                 if (buttonClicked != ButtonClicked::Slider)
                 {
                     ScrollContent(GetScrollDirForButton(buttonClicked), ScrollMagnitude::Small);
@@ -127,7 +211,11 @@ namespace libsdlgui::detail
                 }
                 else
                 {
+                    // keep the point that was grabbed under the mouse while dragging, which
+                    // keeps the slider even when the mouse leaves the scroll bar
                     m_dragSlider = true;
+                    m_dragOffset = buttonEvent.y - m_sliderLoc.y;
+                    CapturePointer();
                 }
             }
         }
@@ -135,9 +223,9 @@ namespace libsdlgui::detail
         {
             m_held = ButtonClicked::None;
 
-            // if the slider is being drug there is no need
-            // to unregister our button-down callback
-            if (!m_dragSlider)
+            // if the slider is being drug or the content is gliding
+            // there is no need to unregister our button-down callback
+            if (!m_dragSlider && !m_gliding)
                 detail::UnregisterForElapsedTimeNotification(GetWindow(), this);
 
             m_dragSlider = false;
@@ -148,7 +236,10 @@ namespace libsdlgui::detail
 
     void VerticalScrollbar::OnMouseExit()
     {
-        detail::UnregisterForElapsedTimeNotification(GetWindow(), this);
+        // the wheel scrolls the content from anywhere so a glide outlives the mouse
+        if (!m_gliding)
+            detail::UnregisterForElapsedTimeNotification(GetWindow(), this);
+
         m_held = ButtonClicked::None;
     }
 
@@ -158,21 +249,48 @@ namespace libsdlgui::detail
         {
             assert(m_showSlider);
 
-            ScrollDirection dir = ScrollDirection::Increment;
-            if (motionEvent.yrel < 0)
-                dir = ScrollDirection::Decrement;
-
-            ScrollContent(dir, ScrollMagnitude::Small);
+            // map the slider's offset along the track back to a position in the range
+            auto upButton = GetButtonBounds(true);
+            auto downButton = GetButtonBounds(false);
+            auto trackTop = upButton.y + upButton.h;
+            auto travel = downButton.y - trackTop - m_sliderLoc.h;
+            if (travel <= 0)
+                return;
+
+            auto offset = std::clamp(motionEvent.y - m_dragOffset - trackTop, 0, travel);
+            auto current = m_min + static_cast<uint32_t>((static_cast<uint64_t>(offset) * (m_max - m_min) + travel / 2) / travel);
+            ScrollTo(current, ScrollMagnitude::Small);
         }
     }
 
     void VerticalScrollbar::OnMouseWheel(const SDL_MouseWheelEvent& wheelEvent)
     {
-        ScrollDirection dir = ScrollDirection::Increment;
-        if (wheelEvent.y > 0)
-            dir = ScrollDirection::Decrement;
+        if (wheelEvent.y == 0)
+            return;
+
+        // while a button or the slider is held scroll in steps as before
+        if (m_held != ButtonClicked::None || m_dragSlider)
+        {
+            ScrollContent(wheelEvent.y > 0 ? ScrollDirection::Decrement : ScrollDirection::Increment, ScrollMagnitude::Small);
+            return;
+        }
 
-        ScrollContent(dir, ScrollMagnitude::Small);
+        // each notch glides a small change, notches in quick succession add up
+        if (!m_gliding)
+        {
+            m_gliding = true;
+            m_glidePosition = m_current;
+            m_glideVelocity = 0;
+            m_glideTicks = GetWindow()->GetTicks();
+            detail::RegisterForElapsedTimeNotification(GetWindow(), this, GlideInterval);
+        }
+
+        m_glideVelocity -= (wheelEvent.y * static_cast<double>(SmallChange())) / GlideTimeConstant;
+    }
+
+    void VerticalScrollbar::OnResize(int, int)
+    {
+        LayoutSlider();
     }
 
     void VerticalScrollbar::RenderImpl()
@@ -197,23 +315,23 @@ namespace libsdlgui::detail
         if (magnitude == ScrollMagnitude::Large)
             toMove = LargeChange();
 
+        auto current = m_current;
         if (direction == ScrollDirection::Decrement)
-        {
-            if (m_current < toMove)
-                toMove = static_cast<uint8_t>(m_current);
-
-            m_current -= toMove;
-        }
+            current -= std::min(toMove, m_current - m_min);
         else
-        {
-            auto remaining = m_current - (m_max);
-            if (toMove > remaining)
-                toMove = static_cast<uint8_t>(remaining);
+            current += std::min(toMove, m_max - m_current);
 
-            m_current += toMove;
-        }
+        ScrollTo(current, magnitude);
+    }
 
-        MoveSlider();
+    void VerticalScrollbar::ScrollTo(uint32_t current, ScrollMagnitude magnitude)
+    {
+        if (current == m_current)
+            return;
+
+        auto direction = current < m_current ? ScrollDirection::Decrement : ScrollDirection::Increment;
+        m_current = current;
+        LayoutSlider();
 
         if (m_scrollCallback != nullptr)
         {
@@ -224,44 +342,35 @@ namespace libsdlgui::detail
 
     void VerticalScrollbar::SetCurrent(uint32_t current)
     {
+        // the content was scrolled by its owner
+        StopGliding();
         m_current = current;
-        MoveSlider();
+        LayoutSlider();
     }
 
     void VerticalScrollbar::SetMaximum(uint32_t max)
     {
         m_max = max;
+        if (m_current > m_max)
+            m_current = m_max;
 
-        // check the size of the control, if it's too
-        // small then don't display the slider
-
-        auto myLoc = GetLocation();
-        auto downButton = GetButtonBounds(false);
-
-        if (myLoc.h > (downButton.h * 3))
-            m_showSlider = true;
-        else
-            m_showSlider = false;
-
-        if (m_showSlider)
-        {
-            // scale the size of the slider based on the number
-            // of items vs the height of the control.  the size
-            // will be capped to keep it from getting too thin.
-
-            auto upButton = GetButtonBounds(true);
+        LayoutSlider();
+    }
 
-            m_sliderLoc = GetLocation();
-            m_sliderLoc.y = upButton.y + upButton.h;
+    void VerticalScrollbar::SetPageSize(uint32_t pageSize)
+    {
+        m_pageSize = pageSize;
+        LayoutSlider();
+    }
 
-            // get the range of pixels available
-            auto range = downButton.y - (upButton.y + upButton.h);
+    void VerticalScrollbar::StopGliding()
+    {
+        if (!m_gliding)
+            return;
 
-            m_sliderLoc.h = static_cast<int>(range - m_max);
-            // don't let the slider get any smaller than a half button
-            if (m_sliderLoc.h < downButton.h / 2)
-                m_sliderLoc.h = downButton.h / 2;
-        }
+        m_gliding = false;
+        m_glideVelocity = 0;
+        detail::UnregisterForElapsedTimeNotification(GetWindow(), this);
     }
 
 } // namespace libsdlgui::detail